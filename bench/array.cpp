@@ -0,0 +1,100 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018-2019 Viktor Kireev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// The numeric buffers: an array of the upl::shared, allocated with its
+// control block, compared with a std::vector inside a upl::shared and
+// with the std::shared_ptr<T[]>.
+
+#include "bench.h"
+
+#include <upl/pointer.h>
+
+#include <vector>
+
+namespace
+{
+
+constexpr std::size_t Size = 4096;
+
+} // namespace
+
+UPL_BENCH(array, upl_make)
+{
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        upl::shared<float[]> p{upl::itself, Size};
+        upl::bench::keep(p);
+    }
+}
+
+UPL_BENCH(array, upl_make_for_overwrite)
+{
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        upl::shared<float[]> p{upl::itself, upl::for_overwrite, std::align_val_t{64}, Size};
+        upl::bench::keep(p);
+    }
+}
+
+UPL_BENCH(array, upl_make_vector)
+{
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        upl::shared<std::vector<float>> p{upl::itself, Size};
+        upl::bench::keep(p);
+    }
+}
+
+UPL_BENCH(array, std_make_shared)
+{
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        std::shared_ptr<float[]> p{new float[Size]()};
+        upl::bench::keep(p);
+    }
+}
+
+UPL_BENCH(array, upl_sum)
+{
+    const upl::shared<float[]> p{upl::itself, std::align_val_t{64}, Size, 1.0f};
+    float sum = 0;
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        for (std::size_t j = 0; j < Size; ++j)
+            sum += p[j];
+        upl::bench::keep(sum);
+    }
+}
+
+UPL_BENCH(array, upl_sum_vector)
+{
+    const upl::shared<std::vector<float>> p{upl::itself, Size, 1.0f};
+    float sum = 0;
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        for (std::size_t j = 0; j < Size; ++j)
+            sum += (*p)[j];
+        upl::bench::keep(sum);
+    }
+}
@@ -0,0 +1,151 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018-2019 Viktor Kireev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// The atomic UPL pointers, compared with the atomic access functions
+// of the std::shared_ptr and with a pointer guarded by a mutex.
+
+#include "bench.h"
+
+#include <upl/pointer.h>
+
+#include <algorithm>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+using upl::bench::object;
+
+// Splits the iterations between the threads, running the body in each.
+template <class Body>
+void contend(std::uint64_t iterations, Body body)
+{
+    const unsigned count = std::clamp(std::thread::hardware_concurrency(), 2u, 32u);
+    std::vector<std::thread> threads;
+    threads.reserve(count);
+    for (unsigned t = 0; t < count; ++t)
+        threads.emplace_back(body, iterations / count + 1);
+
+    for (auto& thread : threads)
+        thread.join();
+}
+
+} // namespace
+
+UPL_BENCH(atomic, upl_load)
+{
+    const upl::atomic_shared<object> a{upl::shared<object>{upl::itself}};
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        auto p = a.load();
+        upl::bench::keep(p);
+    }
+}
+
+UPL_BENCH(atomic, std_load)
+{
+    const auto a = std::make_shared<object>();
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        auto p = std::atomic_load(&a);
+        upl::bench::keep(p);
+    }
+}
+
+UPL_BENCH(atomic, mutex_load)
+{
+    std::mutex mutex;
+    const auto a = std::make_shared<object>();
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        std::unique_lock<std::mutex> lock{mutex};
+        auto p = a;
+        lock.unlock();
+        upl::bench::keep(p);
+    }
+}
+
+UPL_BENCH(atomic, upl_store)
+{
+    upl::atomic_shared<object> a;
+    const upl::shared<object>  source{upl::itself};
+    for (std::uint64_t i = 0; i < iterations; ++i)
+        a.store(source);
+
+    upl::bench::keep(a);
+}
+
+UPL_BENCH(atomic, std_store)
+{
+    std::shared_ptr<object>       a;
+    const std::shared_ptr<object> source = std::make_shared<object>();
+    for (std::uint64_t i = 0; i < iterations; ++i)
+        std::atomic_store(&a, source);
+
+    upl::bench::keep(a);
+}
+
+UPL_BENCH(atomic, upl_load_contended)
+{
+    const upl::atomic_shared<object> a{upl::shared<object>{upl::itself}};
+    contend(iterations, [&](std::uint64_t count)
+    {
+        for (std::uint64_t i = 0; i < count; ++i)
+        {
+            auto p = a.load();
+            upl::bench::keep(p);
+        }
+    });
+}
+
+UPL_BENCH(atomic, std_load_contended)
+{
+    const auto a = std::make_shared<object>();
+    contend(iterations, [&](std::uint64_t count)
+    {
+        for (std::uint64_t i = 0; i < count; ++i)
+        {
+            auto p = std::atomic_load(&a);
+            upl::bench::keep(p);
+        }
+    });
+}
+
+UPL_BENCH(atomic, mutex_load_contended)
+{
+    std::mutex mutex;
+    const auto a = std::make_shared<object>();
+    contend(iterations, [&](std::uint64_t count)
+    {
+        for (std::uint64_t i = 0; i < count; ++i)
+        {
+            std::unique_lock<std::mutex> lock{mutex};
+            auto p = a;
+            lock.unlock();
+            upl::bench::keep(p);
+        }
+    });
+}
@@ -0,0 +1,156 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018-2019 Viktor Kireev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace upl
+{
+
+namespace bench
+{
+
+template <class T>
+inline void keep(T&& value)
+{
+#if defined (__GNUC__)
+    asm volatile ("" : : "g"(&value) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &value;
+#endif
+}
+
+// The object of the benchmarks, which is as small as the usual ones.
+struct object
+{
+    int value[4]{};
+};
+
+struct benchmark
+{
+    std::string                        group;
+    std::string                        name;
+    std::function<void(std::uint64_t)> body;
+};
+
+struct summary
+{
+    std::uint64_t iterations;
+    double        median;
+    double        min;
+};
+
+inline std::vector<benchmark>& registry()
+{
+    static std::vector<benchmark> benchmarks;
+    return benchmarks;
+}
+
+struct registrar
+{
+    registrar(std::string group, std::string name,
+              std::function<void(std::uint64_t)> body)
+    { registry().push_back({std::move(group), std::move(name), std::move(body)}); }
+};
+
+// Runs the body with a growing number of iterations until one run
+// takes long enough to be measured, then repeats it with that number.
+// The first untimed run builds the lazy fixtures of the body.
+inline summary measure(const benchmark& b, int repetitions)
+{
+    using clock = std::chrono::steady_clock;
+
+    const auto time = [&](std::uint64_t iterations)
+    {
+        const auto start = clock::now();
+        b.body(iterations);
+        const std::chrono::duration<double, std::nano> elapsed = clock::now() - start;
+        return elapsed.count();
+    };
+
+    b.body(1);
+
+    std::uint64_t iterations = 1;
+    std::vector<double> samples;
+    for (;;)
+    {
+        const double elapsed = time(iterations);
+        if (elapsed > 1e8 || iterations >= (std::uint64_t{1} << 40))
+        {
+            samples.push_back(elapsed / iterations);
+            break;
+        }
+
+        iterations *= elapsed < 1e6 ? 100 : 2;
+    }
+
+    while (static_cast<int>(samples.size()) < repetitions)
+        samples.push_back(time(iterations) / iterations);
+
+    std::sort(samples.begin(), samples.end());
+    return {iterations, samples[samples.size() / 2], samples.front()};
+}
+
+inline std::string compiler()
+{
+#if defined (__clang__)
+    return "clang " __clang_version__;
+#elif defined (__GNUC__)
+    return "gcc " __VERSION__;
+#elif defined (_MSC_VER)
+    return "msvc " + std::to_string(_MSC_FULL_VER);
+#else
+    return "unknown";
+#endif
+}
+
+inline std::string json_escape(const std::string& text)
+{
+    std::string result;
+    for (char c : text)
+    {
+        if (c == '"' || c == '\\')
+            result += '\\';
+        result += c;
+    }
+
+    return result;
+}
+
+} // namespace bench
+
+} // namespace upl
+
+#define UPL_BENCH(Group, Name)                                                 \
+static void UPL_BENCH_##Group##_##Name(std::uint64_t);                         \
+static ::upl::bench::registrar UPL_BENCH_REGISTRAR_##Group##_##Name            \
+{ #Group, #Name, &UPL_BENCH_##Group##_##Name };                               \
+static void UPL_BENCH_##Group##_##Name(std::uint64_t iterations)
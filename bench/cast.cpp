@@ -0,0 +1,134 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018-2019 Viktor Kireev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// The casts of the pointers, compared with the std::shared_ptr ones,
+// and the cached dynamic cast of a visitor-like hierarchy, compared with
+// the plain one.
+
+#include "bench.h"
+
+#include <upl/pointer.h>
+
+#include <memory>
+
+namespace
+{
+
+struct node
+{
+    virtual ~node() = default;
+};
+
+struct expression : node {};
+struct binary : expression {};
+struct arithmetic : binary {};
+struct sum : arithmetic
+{
+    int value{};
+};
+
+struct visitable
+{
+    virtual ~visitable() = default;
+};
+
+struct statement : node {};
+struct call : statement, visitable {};
+
+} // namespace
+
+UPL_BENCH(cast, upl_static_copy)
+{
+    upl::shared<node> p{upl::itself_type<sum>};
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        auto s = upl::static_pointer_cast<sum>(p);
+        upl::bench::keep(s);
+    }
+}
+
+UPL_BENCH(cast, std_static_copy)
+{
+    std::shared_ptr<node> p = std::make_shared<sum>();
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        auto s = std::static_pointer_cast<sum>(p);
+        upl::bench::keep(s);
+    }
+}
+
+UPL_BENCH(cast, upl_static_move)
+{
+    upl::shared<node> p{upl::itself_type<sum>};
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        auto s = upl::static_pointer_cast<sum>(std::move(p));
+        p = upl::static_pointer_cast<node>(std::move(s));
+        upl::bench::keep(p);
+    }
+}
+
+UPL_BENCH(cast, upl_dynamic_down)
+{
+    upl::shared<node> p{upl::itself_type<sum>};
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        auto s = upl::dynamic_pointer_cast<sum>(std::move(p));
+        p = std::move(s);
+        upl::bench::keep(p);
+    }
+}
+
+UPL_BENCH(cast, upl_cached_dynamic_down)
+{
+    upl::shared<node> p{upl::itself_type<sum>};
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        auto s = upl::cached_dynamic_pointer_cast<sum>(std::move(p));
+        p = std::move(s);
+        upl::bench::keep(p);
+    }
+}
+
+UPL_BENCH(cast, upl_dynamic_cross)
+{
+    upl::shared<node> p{upl::itself_type<call>};
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        auto v = upl::dynamic_pointer_cast<visitable>(std::move(p));
+        p = upl::dynamic_pointer_cast<node>(std::move(v));
+        upl::bench::keep(p);
+    }
+}
+
+UPL_BENCH(cast, upl_cached_dynamic_cross)
+{
+    upl::shared<node> p{upl::itself_type<call>};
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        auto v = upl::cached_dynamic_pointer_cast<visitable>(std::move(p));
+        p = upl::cached_dynamic_pointer_cast<node>(std::move(v));
+        upl::bench::keep(p);
+    }
+}
@@ -0,0 +1,125 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018-2019 Viktor Kireev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// A pass of the cycle collector over a graph of the tracked objects that
+// are alive, and the collection of the garbage rings, per object.
+
+#include "bench.h"
+
+#include <upl/pointer.h>
+
+#include <vector>
+
+namespace
+{
+
+struct node
+{
+    upl::shared<node> next;
+    upl::weak<node>   prev;
+
+    void trace(upl::tracer& t) { t(next, prev); }
+};
+
+constexpr std::size_t Nodes = 1 << 16;
+constexpr std::size_t Ring  = 64;
+
+// The rings of the nodes, each owned from outside by its first node.
+// The rings are collected with the graph, since they keep themselves alive.
+struct graph
+{
+    graph()
+    {
+        for (std::size_t i = 0; i < Nodes; i += Ring)
+            roots.push_back(make_ring());
+    }
+
+    ~graph()
+    {
+        roots.clear();
+        collector.collect();
+    }
+
+    upl::shared<node> make_ring()
+    {
+        upl::shared<node> first{upl::itself};
+        collector.track(first);
+
+        upl::shared<node> last = first;
+        for (std::size_t i = 1; i < Ring; ++i)
+        {
+            upl::shared<node> n{upl::itself};
+            collector.track(n);
+            n->prev    = last;
+            last->next = n;
+            last       = n;
+        }
+
+        last->next = first;
+        return first;
+    }
+
+    upl::cycle_collector           collector;
+    std::vector<upl::shared<node>> roots;
+};
+
+graph alive;
+
+} // namespace
+
+UPL_BENCH(cycle_collector, detect_alive_per_object)
+{
+    std::size_t garbage = 0;
+    for (std::uint64_t i = 0; i < iterations; i += Nodes)
+        garbage += alive.collector.detect().garbage;
+
+    upl::bench::keep(garbage);
+}
+
+// Includes the collection of the graph, which is destroyed.
+UPL_BENCH(cycle_collector, build_per_object)
+{
+    std::size_t tracked = 0;
+    for (std::uint64_t i = 0; i < iterations; i += Nodes)
+    {
+        graph g;
+        tracked += g.collector.size();
+    }
+
+    upl::bench::keep(tracked);
+}
+
+// Includes the building of the graph, see the build_per_object.
+UPL_BENCH(cycle_collector, build_and_collect_per_object)
+{
+    std::size_t collected = 0;
+    for (std::uint64_t i = 0; i < iterations; i += Nodes)
+    {
+        graph g;
+        g.roots.clear();
+        collected += g.collector.collect().collected;
+    }
+
+    upl::bench::keep(collected);
+}
@@ -0,0 +1,100 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018-2019 Viktor Kireev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+// The intrusive ownership, compared with the control block.
+
+#include "bench.h"
+
+#include <upl/pointer.h>
+
+namespace
+{
+
+using upl::bench::object;
+
+struct intrusive_object : upl::intrusive_base
+{
+    int value[4]{};
+};
+
+} // namespace
+
+UPL_BENCH(intrusive, upl_itself)
+{
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        upl::intrusive::shared<intrusive_object> p{upl::itself};
+        upl::bench::keep(p);
+    }
+}
+
+UPL_BENCH(intrusive, upl_control_itself)
+{
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        upl::shared<object> p{upl::itself};
+        upl::bench::keep(p);
+    }
+}
+
+UPL_BENCH(intrusive, upl_copy)
+{
+    const upl::intrusive::shared<intrusive_object> source{upl::itself};
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        upl::intrusive::shared<intrusive_object> p = source;
+        upl::bench::keep(p);
+    }
+}
+
+UPL_BENCH(intrusive, upl_control_copy)
+{
+    const upl::shared<object> source{upl::itself};
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        upl::shared<object> p = source;
+        upl::bench::keep(p);
+    }
+}
+
+UPL_BENCH(intrusive, upl_lock)
+{
+    const upl::intrusive::unique<intrusive_object> source{upl::itself};
+    const upl::intrusive::weak<intrusive_object>   w = source;
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        auto p = w.lock();
+        upl::bench::keep(p);
+    }
+}
+
+UPL_BENCH(intrusive, upl_control_lock)
+{
+    const upl::unique<object> source{upl::itself};
+    const upl::weak<object>   w = source;
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        auto p = w.lock();
+        upl::bench::keep(p);
+    }
+}
@@ -0,0 +1,98 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018-2019 Viktor Kireev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// The false sharing between the counts and the object: half of the threads
+// copy the owners of a hot object while the other half write to its field.
+
+#include "bench.h"
+
+#include <upl/pointer.h>
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+struct hot
+{
+    std::atomic<std::uint64_t> field{0};
+};
+
+unsigned thread_count()
+{
+    return std::clamp(std::thread::hardware_concurrency(), 2u, 32u) & ~1u;
+}
+
+// Splits the iterations between the copying and the writing threads.
+template <class Pointer>
+void copy_and_write(std::uint64_t iterations, const Pointer& source)
+{
+    const unsigned count = thread_count();
+    const std::uint64_t share = iterations / count + 1;
+
+    std::vector<std::thread> threads;
+    threads.reserve(count);
+    for (unsigned t = 0; t < count; t += 2)
+    {
+        threads.emplace_back([&]
+        {
+            for (std::uint64_t i = 0; i < share; ++i)
+            {
+                auto copy = source;
+                upl::bench::keep(copy);
+            }
+        });
+        threads.emplace_back([&]
+        {
+            for (std::uint64_t i = 0; i < share; ++i)
+                source->field.store(i, std::memory_order_relaxed);
+        });
+    }
+
+    for (auto& thread : threads)
+        thread.join();
+}
+
+} // namespace
+
+UPL_BENCH(isolated, upl_itself)
+{
+    const upl::shared<hot> source{upl::itself};
+    copy_and_write(iterations, source);
+}
+
+UPL_BENCH(isolated, upl_itself_isolated)
+{
+    const upl::shared<hot> source{upl::itself_isolated};
+    copy_and_write(iterations, source);
+}
+
+UPL_BENCH(isolated, std_make_shared)
+{
+    const auto source = std::make_shared<hot>();
+    copy_and_write(iterations, source);
+}
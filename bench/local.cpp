@@ -0,0 +1,97 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018-2019 Viktor Kireev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+// The local (non-atomic) ownership, compared with the thread-safe one.
+
+#include "bench.h"
+
+#include <upl/pointer.h>
+
+namespace
+{
+
+using upl::bench::object;
+
+} // namespace
+
+UPL_BENCH(local, upl_copy)
+{
+    const upl::local::shared<object> source{upl::itself};
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        upl::local::shared<object> p = source;
+        upl::bench::keep(p);
+    }
+}
+
+UPL_BENCH(local, upl_concurrent_copy)
+{
+    const upl::shared<object> source{upl::itself};
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        upl::shared<object> p = source;
+        upl::bench::keep(p);
+    }
+}
+
+UPL_BENCH(local, upl_lock)
+{
+    const upl::local::unique<object> source{upl::itself};
+    const upl::local::weak<object>   w = source;
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        auto p = w.lock();
+        upl::bench::keep(p);
+    }
+}
+
+UPL_BENCH(local, upl_concurrent_lock)
+{
+    const upl::unique<object> source{upl::itself};
+    const upl::weak<object>   w = source;
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        auto p = w.lock();
+        upl::bench::keep(p);
+    }
+}
+
+UPL_BENCH(local, upl_weak_copy)
+{
+    const upl::local::unique<object> source{upl::itself};
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        upl::local::weak<object> w = source;
+        upl::bench::keep(w);
+    }
+}
+
+UPL_BENCH(local, upl_concurrent_weak_copy)
+{
+    const upl::unique<object> source{upl::itself};
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        upl::weak<object> w = source;
+        upl::bench::keep(w);
+    }
+}
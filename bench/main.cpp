@@ -0,0 +1,137 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018-2019 Viktor Kireev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "bench.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <tuple>
+
+namespace
+{
+
+struct options
+{
+    bool        json{false};
+    int         repetitions{3};
+    std::string filter;
+};
+
+options parse(int argc, char* argv[])
+{
+    options result;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+
+        if (arg == "--json")
+            result.json = true;
+        else if (arg.compare(0, 14, "--repetitions=") == 0)
+            result.repetitions = std::max(1, std::atoi(arg.c_str() + 14));
+        else
+            result.filter = arg;
+    }
+
+    return result;
+}
+
+const char* build_type()
+{
+#if defined (NDEBUG)
+    return "release";
+#else
+    return "debug";
+#endif
+}
+
+} // namespace
+
+// Usage: UplBench [--json] [--repetitions=N] [group/name prefix]
+int main(int argc, char* argv[])
+{
+    using namespace upl::bench;
+
+    const options opts = parse(argc, argv);
+
+    // The C++ Standard Library may skip atomic operations until the process
+    // starts a second thread, which is not the case the pointers are used in.
+    std::thread{[] {}}.join();
+
+    auto benchmarks = registry();
+    std::sort(benchmarks.begin(), benchmarks.end(),
+              [](const benchmark& a, const benchmark& b)
+              { return std::tie(a.group, a.name) < std::tie(b.group, b.name); });
+
+    if (opts.json)
+    {
+        std::printf("{\n  \"context\": {\n"
+                    "    \"library\": \"upl\",\n"
+                    "    \"version\": \"0.2\",\n"
+                    "    \"compiler\": \"%s\",\n"
+                    "    \"build_type\": \"%s\",\n"
+                    "    \"threads\": %u,\n"
+                    "    \"repetitions\": %d\n"
+                    "  },\n  \"benchmarks\": [",
+                    json_escape(compiler()).c_str(), build_type(),
+                    std::thread::hardware_concurrency(), opts.repetitions);
+    }
+
+    bool first = true;
+    for (const auto& b : benchmarks)
+    {
+        if ((b.group + "/" + b.name).compare(0, opts.filter.size(), opts.filter) != 0)
+            continue;
+
+        const summary s = measure(b, opts.repetitions);
+
+        if (opts.json)
+        {
+            std::printf("%s\n    {\"group\": \"%s\", \"name\": \"%s\", "
+                        "\"iterations\": %llu, \"ns_per_op\": %.3f, "
+                        "\"ns_per_op_min\": %.3f}",
+                        first ? "" : ",",
+                        json_escape(b.group).c_str(), json_escape(b.name).c_str(),
+                        static_cast<unsigned long long>(s.iterations),
+                        s.median, s.min);
+        }
+        else
+        {
+            std::printf("%-12s %-32s %12.2f ns/op (min %.2f)\n",
+                        b.group.c_str(), b.name.c_str(), s.median, s.min);
+        }
+
+        std::fflush(stdout);
+        first = false;
+    }
+
+    if (opts.json)
+        std::printf("\n  ]\n}\n");
+
+    return 0;
+}
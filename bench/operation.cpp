@@ -0,0 +1,133 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018-2019 Viktor Kireev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// The operations that do not change the ownership.
+
+#include "bench.h"
+
+#include <upl/pointer.h>
+
+namespace
+{
+
+using upl::bench::object;
+
+} // namespace
+
+UPL_BENCH(operation, upl_access)
+{
+    const upl::shared<object> p{upl::itself};
+    int sum = 0;
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        upl::access(p, [&](const object& o) { sum += o.value[0]; });
+        upl::bench::keep(p);
+    }
+
+    upl::bench::keep(sum);
+}
+
+UPL_BENCH(operation, std_access)
+{
+    const auto p = std::make_shared<object>();
+    int sum = 0;
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        if (p)
+            sum += p->value[0];
+        upl::bench::keep(p);
+    }
+
+    upl::bench::keep(sum);
+}
+
+UPL_BENCH(operation, upl_swap)
+{
+    upl::shared<object> a{upl::itself};
+    upl::shared<object> b{upl::itself};
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        swap(a, b);
+        upl::bench::keep(a);
+    }
+}
+
+UPL_BENCH(operation, std_swap)
+{
+    auto a = std::make_shared<object>();
+    auto b = std::make_shared<object>();
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        swap(a, b);
+        upl::bench::keep(a);
+    }
+}
+
+UPL_BENCH(operation, upl_owner_before)
+{
+    const upl::shared<object> a{upl::itself};
+    const upl::shared<object> b{upl::itself};
+    const upl::weak<object>   w = b;
+    bool result = false;
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        result ^= a.owner_before(w);
+        upl::bench::keep(result);
+    }
+}
+
+UPL_BENCH(operation, std_owner_before)
+{
+    const auto a = std::make_shared<object>();
+    const auto b = std::make_shared<object>();
+    const std::weak_ptr<object> w = b;
+    bool result = false;
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        result ^= a.owner_before(w);
+        upl::bench::keep(result);
+    }
+}
+
+UPL_BENCH(operation, upl_hash)
+{
+    const upl::shared<object> p{upl::itself};
+    std::size_t result = 0;
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        result += std::hash<upl::shared<object>>{}(p);
+        upl::bench::keep(result);
+    }
+}
+
+UPL_BENCH(operation, std_hash)
+{
+    const auto p = std::make_shared<object>();
+    std::size_t result = 0;
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        result += std::hash<std::shared_ptr<object>>{}(p);
+        upl::bench::keep(result);
+    }
+}
@@ -0,0 +1,126 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018-2019 Viktor Kireev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// The sets of the weak pointers keyed by their owners: the open addressing
+// upl::flat_owner_set, compared with the std::unordered_set.
+
+#include "bench.h"
+
+#include <upl/pointer.h>
+
+#include <unordered_set>
+#include <vector>
+
+namespace
+{
+
+using upl::bench::object;
+
+constexpr std::size_t Population = 1 << 20;
+
+const std::vector<upl::shared<object>>& owners()
+{
+    static const std::vector<upl::shared<object>> instance = []
+    {
+        std::vector<upl::shared<object>> result;
+        result.reserve(Population);
+        for (std::size_t i = 0; i < Population; ++i)
+            result.emplace_back(upl::itself);
+
+        return result;
+    }();
+
+    return instance;
+}
+
+using std_owner_set = std::unordered_set<upl::weak<object>, upl::owner_hash, upl::owner_equal>;
+
+// The sets are filled before the measurements.
+const upl::flat_owner_set<upl::weak<object>> flat_set = []
+{
+    upl::flat_owner_set<upl::weak<object>> result;
+    for (const auto& p : owners())
+        result.insert(p);
+
+    return result;
+}();
+
+const std_owner_set std_set(owners().begin(), owners().end());
+
+} // namespace
+
+UPL_BENCH(owner_set, upl_flat_insert)
+{
+    const auto& source = owners();
+    upl::flat_owner_set<upl::weak<object>> set;
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        if (i % Population == 0)
+            set.clear();
+
+        set.insert(source[i % Population]);
+    }
+
+    upl::bench::keep(set);
+}
+
+UPL_BENCH(owner_set, std_unordered_insert)
+{
+    const auto& source = owners();
+    std_owner_set set;
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        if (i % Population == 0)
+            set.clear();
+
+        set.insert(source[i % Population]);
+    }
+
+    upl::bench::keep(set);
+}
+
+UPL_BENCH(owner_set, upl_flat_find)
+{
+    const auto& source = owners();
+    std::size_t found = 0;
+    for (std::uint64_t i = 0; i < iterations; ++i)
+        found += flat_set.contains(source[(i * 7919) % Population]);
+
+    upl::bench::keep(found);
+}
+
+UPL_BENCH(owner_set, std_unordered_find)
+{
+    const auto& source = owners();
+
+    std::size_t found = 0;
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        // The heterogeneous lookup of the unordered containers is C++20.
+        const upl::weak<object> key = source[(i * 7919) % Population];
+        found += std_set.count(key);
+    }
+
+    upl::bench::keep(found);
+}
@@ -0,0 +1,135 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018-2019 Viktor Kireev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// The churn of the objects of one type: served by a pool,
+// by the thread_cache and by the operator new.
+
+#include "bench.h"
+
+#include <upl/pointer.h>
+
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+struct connection
+{
+    int  fd{-1};
+    char buffer[48]{};
+};
+
+constexpr int Batch = 256;
+
+} // namespace
+
+UPL_BENCH(pool, upl_make)
+{
+    upl::pool<connection> p;
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        upl::unique<connection> c = p.make();
+        upl::bench::keep(c);
+    }
+}
+
+UPL_BENCH(pool, upl_thread_cache)
+{
+    const upl::thread_cache_allocator<connection> alloc;
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        upl::unique<connection> c{std::allocator_arg, alloc, upl::itself};
+        upl::bench::keep(c);
+    }
+}
+
+UPL_BENCH(pool, upl_itself)
+{
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        upl::unique<connection> c{upl::itself};
+        upl::bench::keep(c);
+    }
+}
+
+UPL_BENCH(pool, std_make_shared)
+{
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        auto c = std::make_shared<connection>();
+        upl::bench::keep(c);
+    }
+}
+
+UPL_BENCH(pool, upl_make_batch)
+{
+    upl::pool<connection> p;
+    std::vector<upl::shared<connection>> batch;
+    batch.reserve(Batch);
+    for (std::uint64_t i = 0; i < iterations; i += Batch)
+    {
+        for (int j = 0; j < Batch; ++j)
+            batch.push_back(p.make());
+        batch.clear();
+    }
+}
+
+UPL_BENCH(pool, upl_itself_batch)
+{
+    std::vector<upl::shared<connection>> batch;
+    batch.reserve(Batch);
+    for (std::uint64_t i = 0; i < iterations; i += Batch)
+    {
+        for (int j = 0; j < Batch; ++j)
+            batch.emplace_back(upl::itself);
+        batch.clear();
+    }
+}
+
+// The objects are created by one thread and released by another.
+UPL_BENCH(pool, upl_make_handoff)
+{
+    upl::pool<connection> p;
+    std::vector<upl::shared<connection>> batch;
+    batch.reserve(Batch);
+    for (std::uint64_t i = 0; i < iterations; i += Batch)
+    {
+        for (int j = 0; j < Batch; ++j)
+            batch.push_back(p.make());
+        std::thread{[&] { batch.clear(); }}.join();
+    }
+}
+
+UPL_BENCH(pool, upl_itself_handoff)
+{
+    std::vector<upl::shared<connection>> batch;
+    batch.reserve(Batch);
+    for (std::uint64_t i = 0; i < iterations; i += Batch)
+    {
+        for (int j = 0; j < Batch; ++j)
+            batch.emplace_back(upl::itself);
+        std::thread{[&] { batch.clear(); }}.join();
+    }
+}
@@ -0,0 +1,91 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018-2019 Viktor Kireev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// The release of an object graph by its last owner: destroyed at once,
+// or passed to a reclaimer.
+
+#include "bench.h"
+
+#include <upl/pointer.h>
+
+#include <vector>
+
+namespace
+{
+
+struct node
+{
+    std::vector<upl::unique<node>> children;
+};
+
+constexpr int Children = 64;
+
+upl::unique<node> make_graph()
+{
+    upl::unique<node> root{upl::itself};
+    root->children.reserve(Children);
+    for (int i = 0; i < Children; ++i)
+        root->children.emplace_back(upl::itself);
+
+    return root;
+}
+
+} // namespace
+
+UPL_BENCH(reclaim, upl_release_inline)
+{
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        upl::unique<node> root = make_graph();
+        root = nullptr;
+        upl::bench::keep(root);
+    }
+}
+
+UPL_BENCH(reclaim, upl_release_deferred)
+{
+    upl::reclaimer r;
+    r.start();
+    const upl::reclaimer::scope scope{r};
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        upl::unique<node> root = make_graph();
+        root.defer_destruction();
+        root = nullptr;
+        upl::bench::keep(root);
+    }
+}
+
+UPL_BENCH(reclaim, upl_release_drained)
+{
+    upl::reclaimer r;
+    const upl::reclaimer::scope scope{r};
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        upl::unique<node> root = make_graph();
+        root.defer_destruction();
+        root = nullptr;
+        r.drain(std::chrono::microseconds{10});
+    }
+}
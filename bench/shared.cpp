@@ -0,0 +1,150 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018-2019 Viktor Kireev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// The shared ownership, compared with the std::shared_ptr.
+
+#include "bench.h"
+
+#include <upl/pointer.h>
+
+namespace
+{
+
+using upl::bench::object;
+
+} // namespace
+
+UPL_BENCH(shared, upl_itself)
+{
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        upl::shared<object> p{upl::itself};
+        upl::bench::keep(p);
+    }
+}
+
+UPL_BENCH(shared, std_make_shared)
+{
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        auto p = std::make_shared<object>();
+        upl::bench::keep(p);
+    }
+}
+
+UPL_BENCH(shared, upl_copy)
+{
+    const upl::shared<object> source{upl::itself};
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        upl::shared<object> p = source;
+        upl::bench::keep(p);
+    }
+}
+
+UPL_BENCH(shared, std_copy)
+{
+    const auto source = std::make_shared<object>();
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        std::shared_ptr<object> p = source;
+        upl::bench::keep(p);
+    }
+}
+
+UPL_BENCH(shared, upl_move)
+{
+    upl::shared<object> a{upl::itself};
+    upl::shared<object> b;
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        b = std::move(a);
+        a = std::move(b);
+        upl::bench::keep(a);
+    }
+}
+
+UPL_BENCH(shared, std_move)
+{
+    auto a = std::make_shared<object>();
+    std::shared_ptr<object> b;
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        b = std::move(a);
+        a = std::move(b);
+        upl::bench::keep(a);
+    }
+}
+
+UPL_BENCH(shared, upl_from_unique)
+{
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        upl::unique<object> u{upl::itself};
+        upl::shared<object> p = std::move(u);
+        upl::bench::keep(p);
+    }
+}
+
+UPL_BENCH(shared, std_from_unique)
+{
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        auto u = std::make_unique<object>();
+        std::shared_ptr<object> p = std::move(u);
+        upl::bench::keep(p);
+    }
+}
+
+UPL_BENCH(shared, upl_alias)
+{
+    const upl::shared<object> source{upl::itself};
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        upl::shared<int> p{source, &source->value[1]};
+        upl::bench::keep(p);
+    }
+}
+
+UPL_BENCH(shared, std_alias)
+{
+    const auto source = std::make_shared<object>();
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        std::shared_ptr<int> p{source, &source->value[1]};
+        upl::bench::keep(p);
+    }
+}
+
+// The alias made by the std::shared_ptr, which is the only way without
+// the aliasing constructor: the std::shared_ptr is kept in a new block.
+UPL_BENCH(shared, upl_alias_from_std)
+{
+    const auto source = std::make_shared<object>();
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        upl::shared<int> p{std::shared_ptr<int>{source, &source->value[1]}};
+        upl::bench::keep(p);
+    }
+}
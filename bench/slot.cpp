@@ -0,0 +1,140 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018-2019 Viktor Kireev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// The weak references into a slot arena: checked by a generation compare
+// instead of an atomic count, compared with the upl::weak.
+
+#include "bench.h"
+
+#include <upl/pointer.h>
+
+#include <vector>
+
+namespace
+{
+
+using upl::bench::object;
+
+constexpr int Population = 1024;
+
+} // namespace
+
+UPL_BENCH(slot, upl_make)
+{
+    upl::slot_arena<object> arena;
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        upl::slot::unique<object> p = arena.make();
+        upl::bench::keep(p);
+    }
+}
+
+UPL_BENCH(slot, upl_make_heap)
+{
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        upl::unique<object> p{upl::itself};
+        upl::bench::keep(p);
+    }
+}
+
+UPL_BENCH(slot, upl_expired)
+{
+    upl::slot_arena<object> arena;
+    const upl::slot::unique<object> source = arena.make();
+    const upl::slot::weak<object>   w = source;
+    bool expired = false;
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        upl::bench::keep(w);
+        expired |= w.expired();
+    }
+
+    upl::bench::keep(expired);
+}
+
+UPL_BENCH(slot, upl_expired_heap)
+{
+    const upl::unique<object> source{upl::itself};
+    const upl::weak<object>   w = source;
+    bool expired = false;
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        upl::bench::keep(w);
+        expired |= w.expired();
+    }
+
+    upl::bench::keep(expired);
+}
+
+UPL_BENCH(slot, upl_access)
+{
+    upl::slot_arena<object> arena;
+    const upl::slot::unique<object> source = arena.make();
+    const upl::slot::weak<object>   w = source;
+    int sum = 0;
+    for (std::uint64_t i = 0; i < iterations; ++i)
+        upl::access(w, [&](const object& o) { sum += o.value[0]; });
+
+    upl::bench::keep(sum);
+}
+
+UPL_BENCH(slot, upl_access_heap)
+{
+    const upl::unique<object> source{upl::itself};
+    const upl::weak<object>   w = source;
+    int sum = 0;
+    for (std::uint64_t i = 0; i < iterations; ++i)
+        upl::access(w, [&](const object& o) { sum += o.value[0]; });
+
+    upl::bench::keep(sum);
+}
+
+UPL_BENCH(slot, upl_for_each)
+{
+    upl::slot_arena<object> arena;
+    std::vector<upl::slot::unique<object>> owners;
+    for (int i = 0; i < Population; ++i)
+        owners.push_back(arena.make());
+
+    std::int64_t sum = 0;
+    for (std::uint64_t i = 0; i < iterations; ++i)
+        arena.for_each([&](const object& o) { sum += o.value[0]; });
+
+    upl::bench::keep(sum);
+}
+
+UPL_BENCH(slot, upl_for_each_heap)
+{
+    std::vector<upl::unique<object>> owners;
+    for (int i = 0; i < Population; ++i)
+        owners.emplace_back(upl::itself);
+
+    std::int64_t sum = 0;
+    for (std::uint64_t i = 0; i < iterations; ++i)
+        for (const auto& p : owners)
+            sum += p->value[0];
+
+    upl::bench::keep(sum);
+}
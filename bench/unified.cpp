@@ -0,0 +1,121 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018-2019 Viktor Kireev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// The unified ownership, compared with the std::shared_ptr that plays
+// the same role for the C++ Standard Library pointers.
+
+#include "bench.h"
+
+#include <upl/pointer.h>
+
+namespace
+{
+
+using upl::bench::object;
+
+} // namespace
+
+UPL_BENCH(unified, upl_copy)
+{
+    const upl::unified<object> source = upl::shared<object>{upl::itself};
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        upl::unified<object> p = source;
+        upl::bench::keep(p);
+    }
+}
+
+UPL_BENCH(unified, std_copy)
+{
+    const auto source = std::make_shared<object>();
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        std::shared_ptr<object> p = source;
+        upl::bench::keep(p);
+    }
+}
+
+UPL_BENCH(unified, upl_move)
+{
+    upl::unified<object> a = upl::shared<object>{upl::itself};
+    upl::unified<object> b;
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        b = std::move(a);
+        a = std::move(b);
+        upl::bench::keep(a);
+    }
+}
+
+UPL_BENCH(unified, std_move)
+{
+    auto a = std::make_shared<object>();
+    std::shared_ptr<object> b;
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        b = std::move(a);
+        a = std::move(b);
+        upl::bench::keep(a);
+    }
+}
+
+UPL_BENCH(unified, upl_pin_unique)
+{
+    const upl::unique<object> source{upl::itself};
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        upl::unified<object> p = source;
+        upl::bench::keep(p);
+    }
+}
+
+UPL_BENCH(unified, upl_pin_shared)
+{
+    const upl::shared<object> source{upl::itself};
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        upl::unified<object> p = source;
+        upl::bench::keep(p);
+    }
+}
+
+UPL_BENCH(unified, upl_from_unique)
+{
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        upl::unique<object>  u{upl::itself};
+        upl::unified<object> p = std::move(u);
+        upl::bench::keep(p);
+    }
+}
+
+UPL_BENCH(unified, std_from_unique)
+{
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        auto u = std::make_unique<object>();
+        std::shared_ptr<object> p = std::move(u);
+        upl::bench::keep(p);
+    }
+}
@@ -0,0 +1,175 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018-2019 Viktor Kireev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// The lifecycle of an object with unique ownership, compared with
+// the std::shared_ptr/weak_ptr pair which the UPL pointers wrapped before
+// they got their own control block, and with the std::unique_ptr.
+
+#include "bench.h"
+
+#include <upl/pointer.h>
+
+#include <memory_resource>
+
+namespace
+{
+
+using upl::bench::object;
+
+// A stateless deleter, as for a handle that is returned to its source.
+struct object_deleter
+{
+    void operator()(object* p) const noexcept { delete p; }
+};
+
+} // namespace
+
+UPL_BENCH(unique, upl_itself)
+{
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        upl::unique<object> p{upl::itself};
+        upl::bench::keep(p);
+    }
+}
+
+UPL_BENCH(unique, upl_itself_pool)
+{
+    std::pmr::unsynchronized_pool_resource pool;
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        upl::unique<object> p{std::allocator_arg, &pool, upl::itself};
+        upl::bench::keep(p);
+    }
+}
+
+UPL_BENCH(unique, upl_itself_thread_cache)
+{
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        upl::unique<object> p{std::allocator_arg,
+                              upl::thread_cache_allocator<object>{},
+                              upl::itself};
+        upl::bench::keep(p);
+    }
+}
+
+UPL_BENCH(unique, upl_new)
+{
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        upl::unique<object> p{new object};
+        upl::bench::keep(p);
+    }
+}
+
+UPL_BENCH(unique, upl_deleter)
+{
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        upl::unique<object, upl::tag::optional, object_deleter> p{new object};
+        upl::bench::keep(p);
+    }
+}
+
+UPL_BENCH(unique, std_unique_deleter)
+{
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        std::unique_ptr<object, object_deleter> p{new object};
+        upl::bench::keep(p);
+    }
+}
+
+UPL_BENCH(unique, std_make_shared)
+{
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        auto p = std::make_shared<object>();
+        upl::bench::keep(p);
+    }
+}
+
+UPL_BENCH(unique, std_make_unique)
+{
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        auto p = std::make_unique<object>();
+        upl::bench::keep(p);
+    }
+}
+
+UPL_BENCH(unique, upl_move)
+{
+    upl::unique<object> a{upl::itself};
+    upl::unique<object> b;
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        b = std::move(a);
+        a = std::move(b);
+        upl::bench::keep(a);
+    }
+}
+
+UPL_BENCH(unique, std_shared_move)
+{
+    auto a = std::make_shared<object>();
+    std::shared_ptr<object> b;
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        b = std::move(a);
+        a = std::move(b);
+        upl::bench::keep(a);
+    }
+}
+
+UPL_BENCH(unique, upl_observed)
+{
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        upl::unique<object> p{upl::itself};
+        upl::weak<object>   w = p;
+        upl::bench::keep(w);
+    }
+}
+
+UPL_BENCH(unique, std_shared_observed)
+{
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        auto p = std::make_shared<object>();
+        std::weak_ptr<object> w = p;
+        upl::bench::keep(w);
+    }
+}
+
+UPL_BENCH(unique, upl_to_shared)
+{
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        upl::unique<object> p{upl::itself};
+        upl::shared<object> s = std::move(p);
+        upl::bench::keep(s);
+    }
+}
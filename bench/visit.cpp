@@ -0,0 +1,172 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018-2019 Viktor Kireev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// The lock-free visit of the weak references, compared with the lock,
+// by one thread and by many threads sharing one object, also while
+// a writer retires visited objects.
+
+#include "bench.h"
+
+#include <upl/pointer.h>
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+using upl::bench::object;
+
+unsigned thread_count()
+{
+    return std::clamp(std::thread::hardware_concurrency(), 2u, 32u);
+}
+
+// Splits the iterations between the threads, running the body in each.
+template <class Body>
+void contend(std::uint64_t iterations, Body body)
+{
+    const unsigned count = thread_count();
+    std::vector<std::thread> threads;
+    threads.reserve(count);
+    for (unsigned t = 0; t < count; ++t)
+        threads.emplace_back(body, iterations / count + 1);
+
+    for (auto& thread : threads)
+        thread.join();
+}
+
+// Releases the objects during their visits, so their destruction
+// is deferred, until the stop.
+class retiring_writer
+{
+public:
+    retiring_writer() : m_thread{[this] { run(); }} {}
+
+    ~retiring_writer()
+    {
+        m_stop.store(true, std::memory_order_relaxed);
+        m_thread.join();
+    }
+
+private:
+    void run()
+    {
+        while (!m_stop.load(std::memory_order_relaxed))
+        {
+            upl::unique<object>     owner{upl::itself};
+            const upl::weak<object> w = owner;
+            upl::visit(w, [&](const object&) { owner.reset(); });
+        }
+    }
+
+    std::atomic<bool> m_stop{false};
+    std::thread       m_thread;
+};
+
+} // namespace
+
+UPL_BENCH(visit, upl_visit)
+{
+    const upl::unique<object> source{upl::itself};
+    const upl::weak<object>   w = source;
+    int sum = 0;
+    for (std::uint64_t i = 0; i < iterations; ++i)
+        upl::visit(w, [&](const object& o) { sum += o.value[0]; });
+
+    upl::bench::keep(sum);
+}
+
+UPL_BENCH(visit, upl_access)
+{
+    const upl::unique<object> source{upl::itself};
+    const upl::weak<object>   w = source;
+    int sum = 0;
+    for (std::uint64_t i = 0; i < iterations; ++i)
+        upl::access(w, [&](const object& o) { sum += o.value[0]; });
+
+    upl::bench::keep(sum);
+}
+
+UPL_BENCH(visit, upl_visit_contended)
+{
+    const upl::unique<object> source{upl::itself};
+    const upl::weak<object>   w = source;
+    contend(iterations, [&](std::uint64_t count)
+    {
+        int sum = 0;
+        for (std::uint64_t i = 0; i < count; ++i)
+            upl::visit(w, [&](const object& o) { sum += o.value[0]; });
+
+        upl::bench::keep(sum);
+    });
+}
+
+UPL_BENCH(visit, upl_visit_contended_retiring)
+{
+    const upl::unique<object> source{upl::itself};
+    const upl::weak<object>   w = source;
+    const retiring_writer     writer;
+    contend(iterations, [&](std::uint64_t count)
+    {
+        int sum = 0;
+        for (std::uint64_t i = 0; i < count; ++i)
+            upl::visit(w, [&](const object& o) { sum += o.value[0]; });
+
+        upl::bench::keep(sum);
+    });
+}
+
+UPL_BENCH(visit, upl_access_contended)
+{
+    const upl::unique<object> source{upl::itself};
+    const upl::weak<object>   w = source;
+    contend(iterations, [&](std::uint64_t count)
+    {
+        int sum = 0;
+        for (std::uint64_t i = 0; i < count; ++i)
+            upl::access(w, [&](const object& o) { sum += o.value[0]; });
+
+        upl::bench::keep(sum);
+    });
+}
+
+UPL_BENCH(visit, std_lock_contended)
+{
+    const auto source = std::make_shared<object>();
+    const std::weak_ptr<object> w = source;
+    contend(iterations, [&](std::uint64_t count)
+    {
+        int sum = 0;
+        for (std::uint64_t i = 0; i < count; ++i)
+        {
+            if (auto p = w.lock())
+                sum += p->value[0];
+        }
+
+        upl::bench::keep(sum);
+    });
+}
@@ -0,0 +1,173 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018-2019 Viktor Kireev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// The weak references, compared with the std::weak_ptr.
+
+#include "bench.h"
+
+#include <upl/pointer.h>
+
+namespace
+{
+
+using upl::bench::object;
+
+struct self_object : upl::enable_weak_from_this<self_object>
+{
+    int value[4]{};
+};
+
+struct std_self_object : std::enable_shared_from_this<std_self_object>
+{
+    int value[4]{};
+};
+
+} // namespace
+
+UPL_BENCH(weak, upl_from_strong)
+{
+    const upl::unique<object> source{upl::itself};
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        upl::weak<object> w = source;
+        upl::bench::keep(w);
+    }
+}
+
+UPL_BENCH(weak, std_from_strong)
+{
+    const auto source = std::make_shared<object>();
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        std::weak_ptr<object> w = source;
+        upl::bench::keep(w);
+    }
+}
+
+UPL_BENCH(weak, upl_lock)
+{
+    const upl::unique<object> source{upl::itself};
+    const upl::weak<object>   w = source;
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        auto p = w.lock();
+        upl::bench::keep(p);
+    }
+}
+
+UPL_BENCH(weak, std_lock)
+{
+    const auto source = std::make_shared<object>();
+    const std::weak_ptr<object> w = source;
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        auto p = w.lock();
+        upl::bench::keep(p);
+    }
+}
+
+UPL_BENCH(weak, upl_lock_expired)
+{
+    upl::unique<object>     source{upl::itself};
+    const upl::weak<object> w = source;
+    source = nullptr;
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        auto p = w.lock();
+        upl::bench::keep(p);
+    }
+}
+
+UPL_BENCH(weak, std_lock_expired)
+{
+    const std::weak_ptr<object> w = std::make_shared<object>();
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        auto p = w.lock();
+        upl::bench::keep(p);
+    }
+}
+
+UPL_BENCH(weak, upl_access)
+{
+    const upl::unique<object> source{upl::itself};
+    const upl::weak<object>   w = source;
+    int sum = 0;
+    for (std::uint64_t i = 0; i < iterations; ++i)
+        upl::access(w, [&](const object& o) { sum += o.value[0]; });
+
+    upl::bench::keep(sum);
+}
+
+UPL_BENCH(weak, std_access)
+{
+    const auto source = std::make_shared<object>();
+    const std::weak_ptr<object> w = source;
+    int sum = 0;
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        if (auto p = w.lock())
+            sum += p->value[0];
+    }
+
+    upl::bench::keep(sum);
+}
+
+UPL_BENCH(weak, upl_itself_from_this)
+{
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        upl::unique<self_object> p{upl::itself};
+        upl::bench::keep(p);
+    }
+}
+
+UPL_BENCH(weak, std_make_shared_from_this)
+{
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        auto p = std::make_shared<std_self_object>();
+        upl::bench::keep(p);
+    }
+}
+
+UPL_BENCH(weak, upl_from_this)
+{
+    const upl::unique<self_object> source{upl::itself};
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        auto w = source->weak_from_this();
+        upl::bench::keep(w);
+    }
+}
+
+UPL_BENCH(weak, std_from_this)
+{
+    const auto source = std::make_shared<std_self_object>();
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        auto w = source->weak_from_this();
+        upl::bench::keep(w);
+    }
+}
@@ -0,0 +1,90 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018-2019 Viktor Kireev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// The weak-keyed map with the incremental purge, compared with the
+// std::map of the weak_ptr purged by a full scan, under the churn of
+// the keys: a window of alive objects, the oldest dying on each insert.
+
+#include "bench.h"
+
+#include <upl/pointer.h>
+
+#include <map>
+#include <memory>
+#include <vector>
+
+namespace
+{
+
+struct object
+{
+    int value{};
+};
+
+constexpr std::size_t Window = 1024;
+
+} // namespace
+
+UPL_BENCH(weak_map, upl_churn)
+{
+    std::vector<upl::unique<object>> alive(Window);
+    upl::weak_map<object, std::uint64_t> map;
+    std::uint64_t sum = 0;
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        auto& slot = alive[i % Window];
+        slot = upl::unique<object>{upl::itself};
+        map[slot] = i;
+        if (const std::uint64_t* value = map.find(alive[(i * 7) % Window]))
+            sum += *value;
+    }
+
+    upl::bench::keep(sum);
+}
+
+UPL_BENCH(weak_map, std_map_churn_scan)
+{
+    std::vector<std::shared_ptr<object>> alive(Window);
+    std::map<std::weak_ptr<object>, std::uint64_t, std::owner_less<>> map;
+    std::uint64_t sum = 0;
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        auto& slot = alive[i % Window];
+        slot = std::make_shared<object>();
+        map[slot] = i;
+
+        auto found = map.find(alive[(i * 7) % Window]);
+        if (found != map.end() && !found->first.expired())
+            sum += found->second;
+
+        // The full scan once per window keeps the dead entries bounded.
+        if (i % Window == Window - 1)
+        {
+            for (auto it = map.begin(); it != map.end();)
+                it = it->first.expired() ? map.erase(it) : std::next(it);
+        }
+    }
+
+    upl::bench::keep(sum);
+}
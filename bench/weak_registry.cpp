@@ -0,0 +1,174 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018-2019 Viktor Kireev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// The notification of ten thousand weak subscribers by the registry,
+// compared with the vector under a mutex locking each subscriber,
+// by one thread and by many threads notifying at once, and the subscribe
+// and unsubscribe of ten thousand subscribers.
+
+#include "bench.h"
+
+#include <upl/pointer.h>
+
+#include <algorithm>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+struct subscriber
+{
+    int value{1};
+};
+
+constexpr std::size_t Subscribers = 10000;
+
+struct locked_registry
+{
+    template <class F>
+    std::size_t notify(F&& f)
+    {
+        const std::lock_guard<std::mutex> lock{mutex};
+        std::size_t alive = 0;
+        for (auto it = list.begin(); it != list.end();)
+        {
+            if (upl::access(*it, [&](subscriber& s) { f(s); ++alive; return true; },
+                            [] { return false; }))
+                ++it;
+            else
+                it = list.erase(it);
+        }
+
+        return alive;
+    }
+
+    std::vector<upl::weak<subscriber>> list;
+    std::mutex                         mutex;
+};
+
+const std::vector<upl::unique<subscriber>>& subscribers()
+{
+    static const auto result = []
+    {
+        std::vector<upl::unique<subscriber>> list;
+        for (std::size_t i = 0; i < Subscribers; ++i)
+            list.emplace_back(upl::itself);
+
+        return list;
+    }();
+    return result;
+}
+
+upl::weak_registry<subscriber>& registry()
+{
+    static auto& result = *[]
+    {
+        auto r = new upl::weak_registry<subscriber>;
+        for (const auto& s : subscribers())
+            r->subscribe(s);
+
+        return r;
+    }();
+    return result;
+}
+
+locked_registry& locked()
+{
+    static auto& result = *[]
+    {
+        auto r = new locked_registry;
+        for (const auto& s : subscribers())
+            r->list.emplace_back(s);
+
+        return r;
+    }();
+    return result;
+}
+
+unsigned thread_count()
+{
+    return std::clamp(std::thread::hardware_concurrency(), 2u, 32u);
+}
+
+template <class Body>
+void contend(std::uint64_t iterations, Body body)
+{
+    const unsigned count = thread_count();
+    std::vector<std::thread> threads;
+    threads.reserve(count);
+    for (unsigned t = 0; t < count; ++t)
+        threads.emplace_back(body, iterations / count + 1);
+
+    for (auto& thread : threads)
+        thread.join();
+}
+
+template <class Registry>
+void notify(Registry& r, std::uint64_t iterations)
+{
+    int sum = 0;
+    for (std::uint64_t i = 0; i < iterations; ++i)
+        r.notify([&](const subscriber& s) { sum += s.value; });
+
+    upl::bench::keep(sum);
+}
+
+} // namespace
+
+UPL_BENCH(weak_registry, upl_notify)
+{ notify(registry(), iterations); }
+
+UPL_BENCH(weak_registry, locked_notify)
+{ notify(locked(), iterations); }
+
+UPL_BENCH(weak_registry, upl_notify_contended)
+{
+    auto& r = registry();
+    contend(iterations, [&](std::uint64_t count) { notify(r, count); });
+}
+
+UPL_BENCH(weak_registry, locked_notify_contended)
+{
+    auto& r = locked();
+    contend(iterations, [&](std::uint64_t count) { notify(r, count); });
+}
+
+// One subscribe and one unsubscribe, filling and emptying the registry.
+UPL_BENCH(weak_registry, upl_subscribe_unsubscribe)
+{
+    const auto& list = subscribers();
+    upl::weak_registry<subscriber> r;
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        const auto& s = list[i % Subscribers];
+        if ((i / Subscribers) % 2 == 0)
+            r.subscribe(s);
+        else
+            r.unsubscribe(s);
+    }
+
+    upl::bench::keep(r);
+}
@@ -25,6 +25,20 @@
 #pragma once
 
 #include <upl/v0_2/access.h>
+#include <upl/v0_2/cast.h>
 #include <upl/v0_2/conform.h>
 #include <upl/v0_2/detail/assembly.h>
+#include <upl/v0_2/utility/atomic.h>
+#include <upl/v0_2/utility/cycle_collector.h>
+#include <upl/v0_2/utility/enable_weak_from_this.h>
+#include <upl/v0_2/utility/flat_owner.h>
+#include <upl/v0_2/utility/intrusive_base.h>
+#include <upl/v0_2/utility/owner.h>
+#include <upl/v0_2/utility/pool.h>
+#include <upl/v0_2/utility/reclaimer.h>
+#include <upl/v0_2/utility/slot_arena.h>
+#include <upl/v0_2/utility/stats.h>
+#include <upl/v0_2/utility/thread_cache.h>
 #include <upl/v0_2/utility/unique_carrier.h>
+#include <upl/v0_2/utility/weak_map.h>
+#include <upl/v0_2/utility/weak_registry.h>
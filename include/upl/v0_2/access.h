@@ -73,6 +73,42 @@ auto access(P&& p,
     return failure_action();
 }
 
+// The 'visit' calls the action for the object like the 'access',
+// but a weak pointer does not lock the object, it protects the object
+// with a hazard pointer instead, so the counts of the object are not changed.
+template <class P, class SuccessAction, class FailureAction,
+          UPL_CONCEPT_REQUIRES_(StrongPointer<std::decay_t<P>>)>
+inline
+auto visit(const P& p,
+           SuccessAction success_action,
+           FailureAction failure_action)
+{
+    if (p)
+        return success_action(*p);
+
+    return failure_action();
+}
+
+template <class P, class SuccessAction, class FailureAction,
+          UPL_CONCEPT_REQUIRES_(WeakPointer<std::decay_t<P>>)>
+inline
+auto visit(const P& p,
+           SuccessAction success_action,
+           FailureAction failure_action)
+{
+    return p.visit(success_action, failure_action);
+}
+
+// Returns whether the object was alive.
+template <class P, class SuccessAction>
+inline
+bool visit(const P& p, SuccessAction success_action)
+{
+    return visit(p,
+                 [&](auto& object) { success_action(object); return true; },
+                 [] { return false; });
+}
+
 } // namespace
 
 } // namespace v0_2
@@ -0,0 +1,211 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018-2019 Viktor Kireev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <upl/v0_2/concept.h>
+#include <upl/v0_2/detail/bind.h>
+#include <upl/v0_2/detail/trait.h>
+#include <upl/v0_2/detail/internal/cast.h>
+
+#include <type_traits>
+#include <utility>
+
+namespace upl
+{
+
+inline namespace v0_2
+{
+
+namespace internal
+{
+
+namespace
+{
+
+template <class T, class M>
+std::true_type is_upl_pointer(const detail::internal::base<T, M>*);
+template <class = void>
+std::false_type is_upl_pointer(...);
+
+template <class P>
+struct is_strong : std::bool_constant<StrongPointer<P>> {};
+
+template <class P>
+struct is_weak : std::bool_constant<WeakPointer<P>> {};
+
+// The traits are asked only for the UPL pointers.
+template <class P>
+struct is_strong_pointer
+    : std::conjunction<decltype(is_upl_pointer(std::declval<P*>())), is_strong<P>> {};
+
+template <class P>
+struct is_weak_pointer
+    : std::conjunction<decltype(is_upl_pointer(std::declval<P*>())), is_weak<P>> {};
+
+template <class P>
+inline constexpr bool IsStrongCast = is_strong_pointer<std::decay_t<P>>::value;
+
+template <class P>
+inline constexpr bool IsWeakCast = is_weak_pointer<std::decay_t<P>>::value;
+
+// The pointer of the same ownership and multiplicity to the T.
+template <class T, class P, class Multiplicity = trait::multiplicity_t<std::decay_t<P>>>
+using CastPointer =
+    detail::bind::pointer_t<T, trait::ownership_t<std::decay_t<P>>, Multiplicity>;
+
+// The dynamic_cast may fail, so its pointers are optional.
+template <class T, class P>
+using DynamicCastPointer =
+    CastPointer<T, P, detail::internal::Optional<trait::multiplicity_t<std::decay_t<P>>>>;
+
+template <class Result, class P>
+inline Result cast(P&& p, trait::element_t<Result>* converted)
+{
+    static_assert(!std::is_lvalue_reference_v<P> || !UniquePointer<std::decay_t<P>>,
+                  "a unique pointer is cast by moving it");
+
+    return detail::internal::caster::cast<Result>(std::forward<P>(p), converted);
+}
+
+// A moved pointer keeps its object if the cast fails.
+template <class Result, class P>
+inline Result dynamic_cast_or_empty(P&& p, trait::element_t<Result>* converted)
+{
+    if (!converted)
+        return Result{};
+
+    return cast<Result>(std::forward<P>(p), converted);
+}
+
+} // namespace
+
+} // namespace internal
+
+namespace
+{
+
+// The casts of the strong pointers keep the ownership and multiplicity
+// of the source. A copied source gets one more owner of the object,
+// a moved one passes its ownership to the result.
+template <class T, class P, UPL_CONCEPT_REQUIRES_(internal::IsStrongCast<P>)>
+inline
+internal::CastPointer<T, P> static_pointer_cast(P&& p)
+{
+    using Result = internal::CastPointer<T, P>;
+    return internal::cast<Result>(std::forward<P>(p),
+                                  static_cast<trait::element_t<Result>*>(p.get()));
+}
+
+template <class T, class P, UPL_CONCEPT_REQUIRES_(internal::IsStrongCast<P>)>
+inline
+internal::CastPointer<T, P> const_pointer_cast(P&& p)
+{
+    using Result = internal::CastPointer<T, P>;
+    return internal::cast<Result>(std::forward<P>(p),
+                                  const_cast<trait::element_t<Result>*>(p.get()));
+}
+
+template <class T, class P, UPL_CONCEPT_REQUIRES_(internal::IsStrongCast<P>)>
+inline
+internal::CastPointer<T, P> reinterpret_pointer_cast(P&& p)
+{
+    using Result = internal::CastPointer<T, P>;
+    return internal::cast<Result>(std::forward<P>(p),
+                                  reinterpret_cast<trait::element_t<Result>*>(p.get()));
+}
+
+template <class T, class P, UPL_CONCEPT_REQUIRES_(internal::IsStrongCast<P>)>
+inline
+internal::DynamicCastPointer<T, P> dynamic_pointer_cast(P&& p)
+{
+    using Result = internal::DynamicCastPointer<T, P>;
+    return internal::dynamic_cast_or_empty<Result>(
+        std::forward<P>(p), dynamic_cast<trait::element_t<Result>*>(p.get()));
+}
+
+// Works as the dynamic_pointer_cast, but remembers the results of the type
+// checks for the dynamic types of the objects in a small cache of a thread,
+// so the repeated casts of the objects of the same types are cheaper.
+template <class T, class P, UPL_CONCEPT_REQUIRES_(internal::IsStrongCast<P>)>
+inline
+internal::DynamicCastPointer<T, P> cached_dynamic_pointer_cast(P&& p)
+{
+    using Result  = internal::DynamicCastPointer<T, P>;
+    using Element = std::remove_pointer_t<decltype(p.get())>;
+    using Cache   = detail::internal::dynamic_cast_cache<trait::element_t<Result>, Element>;
+
+    auto source = p.get();
+    return internal::dynamic_cast_or_empty<Result>(
+        std::forward<P>(p), source ? Cache::cast(source) : nullptr);
+}
+
+// The casts of the weak pointers lock the object, since the conversion
+// may access it.
+template <class T, class P, UPL_CONCEPT_REQUIRES_(internal::IsWeakCast<P>)>
+inline
+internal::CastPointer<T, P> static_pointer_cast(const P& p)
+{
+    auto locked = static_pointer_cast<T>(p.lock());
+    return internal::CastPointer<T, P>{locked};
+}
+
+template <class T, class P, UPL_CONCEPT_REQUIRES_(internal::IsWeakCast<P>)>
+inline
+internal::CastPointer<T, P> const_pointer_cast(const P& p)
+{
+    auto locked = const_pointer_cast<T>(p.lock());
+    return internal::CastPointer<T, P>{locked};
+}
+
+template <class T, class P, UPL_CONCEPT_REQUIRES_(internal::IsWeakCast<P>)>
+inline
+internal::CastPointer<T, P> reinterpret_pointer_cast(const P& p)
+{
+    auto locked = reinterpret_pointer_cast<T>(p.lock());
+    return internal::CastPointer<T, P>{locked};
+}
+
+template <class T, class P, UPL_CONCEPT_REQUIRES_(internal::IsWeakCast<P>)>
+inline
+internal::DynamicCastPointer<T, P> dynamic_pointer_cast(const P& p)
+{
+    auto locked = dynamic_pointer_cast<T>(p.lock());
+    return internal::DynamicCastPointer<T, P>{locked};
+}
+
+template <class T, class P, UPL_CONCEPT_REQUIRES_(internal::IsWeakCast<P>)>
+inline
+internal::DynamicCastPointer<T, P> cached_dynamic_pointer_cast(const P& p)
+{
+    auto locked = cached_dynamic_pointer_cast<T>(p.lock());
+    return internal::DynamicCastPointer<T, P>{locked};
+}
+
+} // namespace
+
+} // namespace v0_2
+
+} // namespace upl
@@ -122,6 +122,24 @@ UPL_CONCEPT_SPECIFIER SinglePointer =
     && internal::MultiplicityPointer<P, tag::single>
     && internal::PointerOfElement<P, T>;
 
+template <class P, class T = void>
+UPL_CONCEPT_SPECIFIER LocalPointer =
+    internal::BasePointer<P>
+    && internal::MultiplicityPointer<P, internal::tag::local>
+    && internal::PointerOfElement<P, T>;
+
+template <class P, class T = void>
+UPL_CONCEPT_SPECIFIER IntrusivePointer =
+    internal::BasePointer<P>
+    && internal::MultiplicityPointer<P, internal::tag::intrusive>
+    && internal::PointerOfElement<P, T>;
+
+template <class P, class T = void>
+UPL_CONCEPT_SPECIFIER SlotPointer =
+    internal::BasePointer<P>
+    && internal::MultiplicityPointer<P, internal::tag::slot>
+    && internal::PointerOfElement<P, T>;
+
 } // namespace
 
 } // namespace v0_2
@@ -64,6 +64,17 @@ struct pointer<T, tag::shared, Multiplicity>
 template <class T, class Ownership, class Multiplicity>
 using pointer_t = typename pointer<T, Ownership, Multiplicity>::type;
 
+template <class T, class Multiplicity, class Deleter>
+struct unique_pointer
+{ using type = custom_unique<T, Multiplicity, Deleter>; };
+
+template <class T, class Multiplicity>
+struct unique_pointer<T, Multiplicity, std::default_delete<T>>
+{ using type = pointer_t<T, tag::unique, Multiplicity>; };
+
+template <class T, class Multiplicity, class Deleter>
+using unique_pointer_t = typename unique_pointer<T, Multiplicity, Deleter>::type;
+
 } // namespace bind
 
 } // namespace detail
@@ -43,8 +43,10 @@ using weak = pointer<T, tag::weak, Multiplicity>;
 template <class T, class Multiplicity = tag::optional>
 using unified = pointer<T, tag::unified, Multiplicity>;
 
-template <class T, class Multiplicity = tag::optional>
-using unique = pointer<T, tag::unique, Multiplicity>;
+template <class T,
+          class Multiplicity = tag::optional,
+          class Deleter = std::default_delete<T>>
+using unique = detail::bind::unique_pointer_t<T, Multiplicity, Deleter>;
 
 template <class T, class Multiplicity = tag::optional>
 using shared = pointer<T, tag::shared, Multiplicity>;
@@ -73,6 +75,133 @@ using unique_single = unique<T, tag::single>;
 template <class T>
 using shared_single = shared<T, tag::single>;
 
+namespace local
+{
+
+template <class T, class Multiplicity = tag::local::optional>
+using weak = upl::weak<T, Multiplicity>;
+
+template <class T, class Multiplicity = tag::local::optional>
+using unified = upl::unified<T, Multiplicity>;
+
+template <class T,
+          class Multiplicity = tag::local::optional,
+          class Deleter = std::default_delete<T>>
+using unique = upl::unique<T, Multiplicity, Deleter>;
+
+template <class T, class Multiplicity = tag::local::optional>
+using shared = upl::shared<T, Multiplicity>;
+
+template <class T>
+using weak_optional = weak<T, tag::local::optional>;
+
+template <class T>
+using unified_optional = unified<T, tag::local::optional>;
+
+template <class T>
+using unique_optional = unique<T, tag::local::optional>;
+
+template <class T>
+using shared_optional = shared<T, tag::local::optional>;
+
+template <class T>
+using weak_single = weak<T, tag::local::single>;
+
+template <class T>
+using unified_single = unified<T, tag::local::single>;
+
+template <class T>
+using unique_single = unique<T, tag::local::single>;
+
+template <class T>
+using shared_single = shared<T, tag::local::single>;
+
+} // namespace local
+
+namespace intrusive
+{
+
+template <class T, class Multiplicity = tag::intrusive::optional>
+using weak = upl::weak<T, Multiplicity>;
+
+template <class T, class Multiplicity = tag::intrusive::optional>
+using unified = upl::unified<T, Multiplicity>;
+
+template <class T,
+          class Multiplicity = tag::intrusive::optional,
+          class Deleter = std::default_delete<T>>
+using unique = upl::unique<T, Multiplicity, Deleter>;
+
+template <class T, class Multiplicity = tag::intrusive::optional>
+using shared = upl::shared<T, Multiplicity>;
+
+template <class T>
+using weak_optional = weak<T, tag::intrusive::optional>;
+
+template <class T>
+using unified_optional = unified<T, tag::intrusive::optional>;
+
+template <class T>
+using unique_optional = unique<T, tag::intrusive::optional>;
+
+template <class T>
+using shared_optional = shared<T, tag::intrusive::optional>;
+
+template <class T>
+using weak_single = weak<T, tag::intrusive::single>;
+
+template <class T>
+using unified_single = unified<T, tag::intrusive::single>;
+
+template <class T>
+using unique_single = unique<T, tag::intrusive::single>;
+
+template <class T>
+using shared_single = shared<T, tag::intrusive::single>;
+
+} // namespace intrusive
+
+namespace slot
+{
+
+template <class T, class Multiplicity = tag::slot::optional>
+using weak = upl::weak<T, Multiplicity>;
+
+template <class T, class Multiplicity = tag::slot::optional>
+using unified = upl::unified<T, Multiplicity>;
+
+template <class T, class Multiplicity = tag::slot::optional>
+using unique = upl::unique<T, Multiplicity>;
+
+template <class T, class Multiplicity = tag::slot::optional>
+using shared = upl::shared<T, Multiplicity>;
+
+template <class T>
+using weak_optional = weak<T, tag::slot::optional>;
+
+template <class T>
+using unified_optional = unified<T, tag::slot::optional>;
+
+template <class T>
+using unique_optional = unique<T, tag::slot::optional>;
+
+template <class T>
+using shared_optional = shared<T, tag::slot::optional>;
+
+template <class T>
+using weak_single = weak<T, tag::slot::single>;
+
+template <class T>
+using unified_single = unified<T, tag::slot::single>;
+
+template <class T>
+using unique_single = unique<T, tag::slot::single>;
+
+template <class T>
+using shared_single = shared<T, tag::slot::single>;
+
+} // namespace slot
+
 } // namespace v0_2
 
 } // namespace upl
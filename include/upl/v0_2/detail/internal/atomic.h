@@ -0,0 +1,277 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018-2019 Viktor Kireev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <upl/v0_2/exception.h>
+
+#include "hazard.h"
+#include "pointer.h"
+
+#include <atomic>
+#include <type_traits>
+#include <utility>
+
+namespace upl
+{
+
+inline namespace v0_2
+{
+
+namespace detail
+{
+
+namespace internal
+{
+
+// The atomic pointer keeps its value in an immutable node, so the value
+// is replaced by one exchange of the node pointer. A reader protects
+// the node by a hazard pointer while it copies the value, and the writer
+// defers the deletion of a replaced node until no reader protects it.
+// The readers take no lock and never reclaim the nodes, the writers
+// reclaim them in batches. The pointer is not always lock-free: a writer
+// allocates a node, and the first access of a thread registers
+// its hazard slots under a lock.
+template <template <class Y, class M> class Pointer, class T, class Multiplicity>
+class atomic_pointer
+{
+    static_assert(!IsLocal<Multiplicity> && !IsSlot<Multiplicity>,
+                  "a local or slot pointer can't be shared between threads");
+
+    static constexpr bool IsOptional = internal::IsOptional<Multiplicity>;
+    static constexpr bool IsSingle   = internal::IsSingle<Multiplicity>;
+
+public:
+    using value_type = Pointer<T, Multiplicity>;
+
+    static constexpr bool is_always_lock_free = false;
+
+    UPL_CONCEPT_REQUIRES(IsOptional)
+    constexpr atomic_pointer() noexcept {}
+
+    UPL_CONCEPT_REQUIRES(IsOptional)
+    constexpr atomic_pointer(std::nullptr_t) noexcept {}
+
+    UPL_CONCEPT_REQUIRES(IsSingle)
+    atomic_pointer() = delete;
+
+    atomic_pointer(value_type desired)
+        : m_node{make_node(std::move(desired))} {}
+
+    atomic_pointer(const atomic_pointer&) = delete;
+    atomic_pointer& operator=(const atomic_pointer&) = delete;
+
+    ~atomic_pointer() { delete m_node.load(std::memory_order_relaxed); }
+
+    bool is_lock_free() const noexcept { return is_always_lock_free; }
+
+    // All the operations are sequentially consistent, the order
+    // is accepted for the compatibility with the std::atomic.
+    value_type load(std::memory_order = std::memory_order_seq_cst) const
+    {
+        for (;;)
+        {
+            node* n = m_node.load(std::memory_order_seq_cst);
+            if constexpr (IsOptional)
+                if (n == nullptr)
+                    return value_type{};
+
+            const protection guard{n};
+            if (m_node.load(std::memory_order_seq_cst) == n)
+                return n->value;
+        }
+    }
+
+    operator value_type() const { return load(); }
+
+    void store(value_type desired, std::memory_order = std::memory_order_seq_cst)
+    { retire(m_node.exchange(make_node(std::move(desired)), std::memory_order_seq_cst)); }
+
+    void operator=(value_type desired) { store(std::move(desired)); }
+
+    UPL_CONCEPT_REQUIRES(IsOptional)
+    void operator=(std::nullptr_t) { store(value_type{}); }
+
+    UPL_CONCEPT_REQUIRES(IsSingle)
+    void operator=(std::nullptr_t) = delete;
+
+    value_type exchange(value_type desired,
+                        std::memory_order = std::memory_order_seq_cst)
+    {
+        node* n = m_node.exchange(make_node(std::move(desired)),
+                                  std::memory_order_seq_cst);
+        if constexpr (IsOptional)
+            if (n == nullptr)
+                return value_type{};
+
+        // The node is unreachable now, so a reader that does not protect it
+        // yet will not use it.
+        if (!hazard::is_protected(n))
+        {
+            value_type result{std::move(n->value)};
+            delete n;
+            return result;
+        }
+
+        value_type result{n->value};
+        retire(n);
+        return result;
+    }
+
+    bool compare_exchange_strong(value_type& expected, value_type desired,
+                                 std::memory_order = std::memory_order_seq_cst,
+                                 std::memory_order = std::memory_order_seq_cst)
+    {
+        node* d = make_node(std::move(desired));
+        for (;;)
+        {
+            node* n = m_node.load(std::memory_order_seq_cst);
+            if (n == nullptr)
+            {
+                if (!is_empty(expected))
+                {
+                    delete d;
+                    expected = value_type{};
+                    return false;
+                }
+            }
+            else
+            {
+                const protection guard{n};
+                if (m_node.load(std::memory_order_seq_cst) != n)
+                    continue;
+
+                if (!is_equivalent(n->value, expected))
+                {
+                    delete d;
+                    expected = n->value;
+                    return false;
+                }
+            }
+
+            if (m_node.compare_exchange_strong(n, d, std::memory_order_seq_cst))
+            {
+                retire(n);
+                return true;
+            }
+        }
+    }
+
+    bool compare_exchange_weak(value_type& expected, value_type desired,
+                               std::memory_order success = std::memory_order_seq_cst,
+                               std::memory_order failure = std::memory_order_seq_cst)
+    { return compare_exchange_strong(expected, std::move(desired), success, failure); }
+
+private:
+    struct node
+    {
+        value_type value;
+
+#if defined (UPL_THREAD_CACHE)
+        static void* operator new(std::size_t size)
+        { return thread_cache::allocate(size); }
+
+        static void operator delete(void* p, std::size_t size) noexcept
+        { thread_cache::deallocate(p, size); }
+#endif
+    };
+
+    class protection
+    {
+    public:
+        explicit protection(const node* n) noexcept
+            : m_slot{hazard::protect_or_pin(n)} {}
+
+        ~protection() { hazard::unprotect_or_unpin(m_slot); }
+
+        protection(const protection&) = delete;
+        protection& operator=(const protection&) = delete;
+
+    private:
+        hazard::slot* m_slot;
+    };
+
+    // The empty optional value is kept as the null node.
+    static node* make_node(value_type&& value)
+    {
+        if (is_empty(value))
+        {
+            if constexpr (IsSingle)
+                throw single_error{"'single' can't be stored as a null pointer"};
+
+            return nullptr;
+        }
+
+        return new node{std::move(value)};
+    }
+
+    static void retire(node* n) noexcept
+    {
+        if (n != nullptr && !hazard::defer(n, &reclaim))
+            delete n;
+    }
+
+    static void reclaim(const void* p) noexcept
+    { delete static_cast<const node*>(p); }
+
+    // The empty pointer has no owner, and the access to an empty 'single'
+    // is not valid, so only the owners are compared.
+    static bool is_empty(const value_type& value)
+    {
+        const Pointer<T, Optional<Multiplicity>> empty;
+        return is_same_owner(value, empty);
+    }
+
+    template <class U>
+    static bool is_same_owner(const value_type& a, const U& b)
+    { return !a.owner_before(b) && !b.owner_before(a); }
+
+    // The values are equivalent, as the std::atomic<std::weak_ptr> requires,
+    // if they store the same pointer and share the owner.
+    static bool is_equivalent(const value_type& a, const value_type& b)
+    {
+        if constexpr (std::is_base_of_v<strong<T, Multiplicity>, value_type>)
+        {
+            if (a.get() != b.get())
+                return false;
+        }
+        else
+        {
+            if (!a.stores_same(b))
+                return false;
+        }
+
+        return is_same_owner(a, b);
+    }
+
+    std::atomic<node*> m_node{nullptr};
+};
+
+} // namespace internal
+
+} // namespace detail
+
+} // namespace v0_2
+
+} // namespace upl
@@ -0,0 +1,122 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018-2019 Viktor Kireev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#pragma once
+
+#include "pointer.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <typeinfo>
+#include <utility>
+
+namespace upl
+{
+
+inline namespace v0_2
+{
+
+namespace detail
+{
+
+namespace internal
+{
+
+// Makes the pointers that refer to the objects of other pointers by their
+// cast pointers. A copied source gets one more owner, and a moved one
+// passes its ownership. A bare unique gets its control block, if the cast
+// changes its address or type, so the cast of a unique may throw.
+struct caster
+{
+    template <class Result, class Source>
+    static Result cast(Source&& source, typename Result::element_type* p)
+    {
+        return Result{aliasing_t{},
+                      attacher::alias<typename Result::element_type>(
+                          std::forward<Source>(source), p),
+                      p};
+    }
+};
+
+// Remembers the results of the dynamic_cast from the Y to the T by
+// the dynamic type of an object and the offset of the Y in it, which
+// tells the repeated bases apart. The cache is a small direct-mapped table
+// of a thread, so it takes no synchronization.
+template <class T, class Y>
+class dynamic_cast_cache
+{
+public:
+    static T* cast(Y* p)
+    {
+        const std::type_info* type = &typeid(*p);
+        const std::ptrdiff_t offset =
+            address(p) - address(dynamic_cast<const volatile void*>(p));
+
+        const std::size_t index =
+            reinterpret_cast<std::uintptr_t>(type) / alignof(std::type_info)
+            + std::size_t(offset);
+
+        entry& cached = t_entries[index % Size];
+        if (cached.type != type || cached.offset != offset)
+        {
+            T* result = dynamic_cast<T*>(p);
+
+            cached.type    = type;
+            cached.offset  = offset;
+            cached.success = result != nullptr;
+            cached.shift   = result ? address(result) - address(p) : 0;
+            return result;
+        }
+
+        if (!cached.success)
+            return nullptr;
+
+        return reinterpret_cast<T*>(const_cast<char*>(address(p) + cached.shift));
+    }
+
+private:
+    struct entry
+    {
+        const std::type_info* type;
+        std::ptrdiff_t        offset;
+        std::ptrdiff_t        shift;
+        bool                  success;
+    };
+
+    static constexpr std::size_t Size = 16;
+
+    static const volatile char* address(const volatile void* p) noexcept
+    { return static_cast<const volatile char*>(p); }
+
+    static inline thread_local entry t_entries[Size]{};
+};
+
+} // namespace internal
+
+} // namespace detail
+
+} // namespace v0_2
+
+} // namespace upl
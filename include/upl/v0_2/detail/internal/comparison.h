@@ -141,8 +141,102 @@ inline bool
 operator>=(std::nullptr_t, const strong<T, TM>& a) noexcept
 { return !(nullptr < a); }
 
+// The stored pointers of the operands of a custom_unique.
+template <class T, class TM>
+inline auto stored(const strong<T, TM>& a) noexcept
+{ return a.get(); }
+
+template <class T, class TM, class D>
+inline auto stored(const custom_unique<T, TM, D>& a) noexcept
+{ return a.get(); }
+
+inline std::nullptr_t stored(std::nullptr_t) noexcept
+{ return nullptr; }
+
+template <class A, class B>
+inline bool stored_less(const A& a, const B& b) noexcept
+{
+    using V = std::common_type_t<decltype(stored(a)), decltype(stored(b))>;
+    return std::less<V>()(stored(a), stored(b));
+}
+
+template <class P>
+inline constexpr bool IsCustomUnique = false;
+
+template <class T, class TM, class D>
+inline constexpr bool IsCustomUnique<custom_unique<T, TM, D>> = true;
+
 } // namespace internal
 
+// A custom_unique keeps its unique to itself, so it is compared with
+// the strong pointers, the other custom_unique and the nullptr by
+// the operators of its own.
+template <class T, class TM, class D, class P>
+inline auto operator==(const custom_unique<T, TM, D>& a, const P& b) noexcept
+    -> decltype(internal::stored(b), bool())
+{ return a.get() == internal::stored(b); }
+
+template <class P, class T, class TM, class D,
+          UPL_CONCEPT_REQUIRES_(!internal::IsCustomUnique<P>)>
+inline auto operator==(const P& a, const custom_unique<T, TM, D>& b) noexcept
+    -> decltype(internal::stored(a), bool())
+{ return b == a; }
+
+template <class T, class TM, class D, class P>
+inline auto operator!=(const custom_unique<T, TM, D>& a, const P& b) noexcept
+    -> decltype(internal::stored(b), bool())
+{ return !(a == b); }
+
+template <class P, class T, class TM, class D,
+          UPL_CONCEPT_REQUIRES_(!internal::IsCustomUnique<P>)>
+inline auto operator!=(const P& a, const custom_unique<T, TM, D>& b) noexcept
+    -> decltype(internal::stored(a), bool())
+{ return !(b == a); }
+
+template <class T, class TM, class D, class P>
+inline auto operator<(const custom_unique<T, TM, D>& a, const P& b) noexcept
+    -> decltype(internal::stored(b), bool())
+{ return internal::stored_less(a, b); }
+
+template <class P, class T, class TM, class D,
+          UPL_CONCEPT_REQUIRES_(!internal::IsCustomUnique<P>)>
+inline auto operator<(const P& a, const custom_unique<T, TM, D>& b) noexcept
+    -> decltype(internal::stored(a), bool())
+{ return internal::stored_less(a, b); }
+
+template <class T, class TM, class D, class P>
+inline auto operator>(const custom_unique<T, TM, D>& a, const P& b) noexcept
+    -> decltype(internal::stored(b), bool())
+{ return internal::stored_less(b, a); }
+
+template <class P, class T, class TM, class D,
+          UPL_CONCEPT_REQUIRES_(!internal::IsCustomUnique<P>)>
+inline auto operator>(const P& a, const custom_unique<T, TM, D>& b) noexcept
+    -> decltype(internal::stored(a), bool())
+{ return internal::stored_less(b, a); }
+
+template <class T, class TM, class D, class P>
+inline auto operator<=(const custom_unique<T, TM, D>& a, const P& b) noexcept
+    -> decltype(internal::stored(b), bool())
+{ return !internal::stored_less(b, a); }
+
+template <class P, class T, class TM, class D,
+          UPL_CONCEPT_REQUIRES_(!internal::IsCustomUnique<P>)>
+inline auto operator<=(const P& a, const custom_unique<T, TM, D>& b) noexcept
+    -> decltype(internal::stored(a), bool())
+{ return !internal::stored_less(b, a); }
+
+template <class T, class TM, class D, class P>
+inline auto operator>=(const custom_unique<T, TM, D>& a, const P& b) noexcept
+    -> decltype(internal::stored(b), bool())
+{ return !internal::stored_less(a, b); }
+
+template <class P, class T, class TM, class D,
+          UPL_CONCEPT_REQUIRES_(!internal::IsCustomUnique<P>)>
+inline auto operator>=(const P& a, const custom_unique<T, TM, D>& b) noexcept
+    -> decltype(internal::stored(a), bool())
+{ return !internal::stored_less(a, b); }
+
 } // namespace detail
 
 } // namespace v0_2
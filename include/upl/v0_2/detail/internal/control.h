@@ -0,0 +1,627 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018-2019 Viktor Kireev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include <upl/v0_2/utility/reclaimer.h>
+#include <upl/v0_2/utility/stats.h>
+
+#if defined (UPL_THREAD_CACHE)
+#include <upl/v0_2/utility/thread_cache.h>
+#endif
+
+#include "hazard.h"
+
+namespace upl
+{
+
+inline namespace v0_2
+{
+
+namespace detail
+{
+
+namespace internal
+{
+
+#if defined (UPL_THREAD_CACHE)
+template <class T>
+using default_allocator = thread_cache_allocator<T>;
+#else
+template <class T>
+using default_allocator = std::allocator<T>;
+#endif
+
+// The std::atomic interface over a plain value.
+template <class T>
+class plain
+{
+public:
+    constexpr plain(T value) noexcept : m_value{value} {}
+
+    T load(std::memory_order = std::memory_order_seq_cst) const noexcept
+    { return m_value; }
+
+    T fetch_add(T arg, std::memory_order = std::memory_order_seq_cst) noexcept
+    { return std::exchange(m_value, m_value + arg); }
+
+    T fetch_sub(T arg, std::memory_order = std::memory_order_seq_cst) noexcept
+    { return std::exchange(m_value, m_value - arg); }
+
+    bool compare_exchange_weak(T& expected, T desired,
+                               std::memory_order, std::memory_order) noexcept
+    {
+        if (m_value != expected)
+        {
+            expected = m_value;
+            return false;
+        }
+
+        m_value = desired;
+        return true;
+    }
+
+private:
+    T m_value;
+};
+
+// Counts the references to the objects that are shared between threads.
+struct concurrent_policy
+{
+    template <class T>
+    using counter = std::atomic<T>;
+
+    static constexpr stats::kind StatKind = stats::kind::concurrent;
+};
+
+// Counts the references to the objects that never leave their thread.
+struct local_policy
+{
+    template <class T>
+    using counter = plain<T>;
+
+    static constexpr stats::kind StatKind = stats::kind::local;
+};
+
+// The control block of an owned object.
+// Both counters are packed into one word, so the sole owner without
+// observers can be detected by a single load, and its release does not need
+// an atomic read-modify-write.
+template <class Policy>
+class control
+{
+public:
+    control(const control&) = delete;
+    control& operator=(const control&) = delete;
+
+    void add_use() noexcept
+    {
+        UPL_STAT(add_use, Policy::StatKind);
+        m_counts.fetch_add(UseUnit, std::memory_order_relaxed);
+    }
+
+    bool try_add_use() noexcept
+    {
+        Counts counts = m_counts.load(std::memory_order_relaxed);
+        while ((counts & UseMask) != 0)
+        {
+            if (m_counts.compare_exchange_weak(counts, counts + UseUnit,
+                                               std::memory_order_acq_rel,
+                                               std::memory_order_relaxed))
+            {
+                UPL_STAT(add_use, Policy::StatKind);
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    // Turns a weak reference into a use by one read-modify-write. The weak
+    // count does not drop to zero, since the owners hold the implicit one.
+    bool try_promote() noexcept
+    {
+        Counts counts = m_counts.load(std::memory_order_relaxed);
+        while ((counts & UseMask) != 0)
+        {
+            if (m_counts.compare_exchange_weak(counts, counts + UseUnit - WeakUnit,
+                                               std::memory_order_acq_rel,
+                                               std::memory_order_relaxed))
+            {
+                UPL_STAT(promote, Policy::StatKind);
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    void release() noexcept
+    {
+        UPL_STAT(release, Policy::StatKind);
+
+        // Nobody else can reach the block, so there is nothing to race with.
+        if (m_counts.load(std::memory_order_acquire) == UseUnit + WeakUnit)
+        {
+            dispose();
+            destroy();
+            return;
+        }
+
+        // It is ordered with the hazards of the visiting readers.
+        const Counts counts = m_counts.fetch_sub(UseUnit, std::memory_order_seq_cst);
+        if ((counts & UseMask) == UseUnit)
+        {
+            if constexpr (IsConcurrent)
+            {
+                if ((counts & VisitedFlag) && hazard::defer(this, &reclaim))
+                    return;
+
+                if ((counts & DeferredFlag) && reclaimer::defer(this, &finish))
+                    return;
+            }
+
+            dispose();
+            release_weak();
+        }
+    }
+
+    void add_weak() noexcept
+    {
+        UPL_STAT(add_weak, Policy::StatKind);
+        m_counts.fetch_add(WeakUnit, std::memory_order_relaxed);
+    }
+
+    void release_weak() noexcept
+    {
+        UPL_STAT(release_weak, Policy::StatKind);
+        if ((m_counts.fetch_sub(WeakUnit, std::memory_order_acq_rel) & ~FlagMask) == WeakUnit)
+            destroy();
+    }
+
+    // Makes the last owner pass the object to the reclaimer instead of
+    // destroying it.
+    void defer_destruction() noexcept
+    {
+        static_assert(IsConcurrent, "only the shared objects are reclaimed");
+        m_counts.fetch_or(DeferredFlag, std::memory_order_relaxed);
+    }
+
+    // Returns whether the object is owned. The block must be published
+    // as a hazard before, then the object is not destroyed until
+    // the hazard is cleared. The first visit marks the block, so that
+    // its last owner looks for the hazards.
+    bool visit() noexcept
+    {
+        static_assert(IsConcurrent, "only the shared objects are visited");
+
+        Counts counts = m_counts.load(std::memory_order_seq_cst);
+        if (!(counts & VisitedFlag))
+            counts = m_counts.fetch_or(VisitedFlag, std::memory_order_seq_cst);
+
+        return (counts & UseMask) != 0;
+    }
+
+#if defined (UPL_THREAD_CACHE)
+    static void* operator new(std::size_t size)
+    { return thread_cache::allocate(size); }
+
+    static void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+    {
+        try
+        {
+            return thread_cache::allocate(size);
+        }
+        catch (...)
+        {
+            return nullptr;
+        }
+    }
+
+    static void operator delete(void* p, std::size_t size) noexcept
+    { thread_cache::deallocate(p, size); }
+#endif
+
+    // Frees a block that has never owned its object.
+    void discard() noexcept { destroy(); }
+
+    long use_count() const noexcept
+    { return static_cast<long>(m_counts.load(std::memory_order_relaxed) & UseMask); }
+
+    bool expired() const noexcept
+    { return use_count() == 0 && !has_external_owner(); }
+
+    // Returns a new control block for an object that is not owned
+    // by the UPL pointers anymore but is still alive, or nullptr.
+    virtual control* relock() noexcept { return nullptr; }
+
+    // Returns the deleter of the object, if the block keeps one.
+    virtual void* deleter() noexcept { return nullptr; }
+
+    // Returns the std::shared_ptr that owns the object, if any.
+    virtual const std::shared_ptr<const void>* std_owner() const noexcept
+    { return nullptr; }
+
+protected:
+    using Counts = std::uint64_t;
+
+    static constexpr Counts UseUnit     = 1;
+    static constexpr Counts WeakUnit    = Counts{1} << 32;
+    static constexpr Counts UseMask     = WeakUnit - 1;
+    static constexpr Counts VisitedFlag  = Counts{1} << 63;
+    static constexpr Counts DeferredFlag = Counts{1} << 62;
+    static constexpr Counts FlagMask     = VisitedFlag | DeferredFlag;
+
+    static constexpr bool IsConcurrent = std::is_same_v<Policy, concurrent_policy>;
+
+    // Every control block is created with one use and the implicit weak
+    // reference that is held by all uses together.
+    control() noexcept : m_counts{UseUnit + WeakUnit} {}
+
+    // Creates a block that has no uses yet, only one weak reference.
+    struct observer_t {};
+    explicit control(observer_t) noexcept : m_counts{WeakUnit} {}
+
+    virtual ~control() = default;
+
+    // Destroys the owned object.
+    virtual void dispose() noexcept = 0;
+    // Frees the block itself.
+    virtual void destroy() noexcept = 0;
+
+    virtual bool has_external_owner() const noexcept { return false; }
+
+private:
+    // Is called by a batch of the releasing thread, when no reader
+    // protects the released object anymore.
+    static void reclaim(const void* p) noexcept
+    {
+        auto block = const_cast<control*>(static_cast<const control*>(p));
+        if ((block->m_counts.load(std::memory_order_relaxed) & DeferredFlag)
+            && reclaimer::defer(p, &finish))
+            return;
+
+        finish(p);
+    }
+
+    static void finish(const void* p) noexcept
+    {
+        auto block = const_cast<control*>(static_cast<const control*>(p));
+        block->dispose();
+        block->release_weak();
+    }
+
+    typename Policy::template counter<Counts> m_counts;
+};
+
+// Keeps an empty T without spending a byte on it.
+template <class T, bool = std::is_empty_v<T> && !std::is_final_v<T>>
+class compressed : private T
+{
+public:
+    explicit compressed(T value) : T{std::move(value)} {}
+
+    T&       get() noexcept       { return *this; }
+    const T& get() const noexcept { return *this; }
+};
+
+template <class T>
+class compressed<T, false>
+{
+public:
+    explicit compressed(T value) : m_value{std::move(value)} {}
+
+    T&       get() noexcept       { return m_value; }
+    const T& get() const noexcept { return m_value; }
+
+private:
+    T m_value;
+};
+
+// The size of a cache line, which the isolated objects are aligned to.
+inline constexpr std::size_t CacheLineSize = 64;
+
+// The block and the object are placed in one allocation,
+// which is obtained from the Alloc. An Isolated object starts on its own
+// cache line, so the writes to the object and to the counts do not
+// contend for one line.
+template <class Y, class Alloc, class Policy, bool Isolated = false>
+class inplace_control final : public control<Policy>,
+                              private compressed<Alloc>
+{
+    static constexpr std::size_t StorageAlignment =
+        Isolated && alignof(Y) < CacheLineSize ? CacheLineSize : alignof(Y);
+
+    using Object       = std::remove_cv_t<Y>;
+    using ObjectAlloc  = typename std::allocator_traits<Alloc>::template rebind_alloc<Object>;
+    using ObjectTraits = std::allocator_traits<ObjectAlloc>;
+    using BlockAlloc   = typename std::allocator_traits<Alloc>::template rebind_alloc<inplace_control>;
+    using BlockTraits  = std::allocator_traits<BlockAlloc>;
+
+public:
+    template <class ... Args>
+    static inplace_control* create(const Alloc& alloc, Args&& ... args)
+    {
+        UPL_STAT(itself_allocation, Policy::StatKind);
+
+        BlockAlloc block_alloc{alloc};
+        auto       memory = BlockTraits::allocate(block_alloc, 1);
+        try
+        {
+            return ::new (static_cast<void*>(std::addressof(*memory)))
+                   inplace_control{alloc, std::forward<Args>(args) ...};
+        }
+        catch (...)
+        {
+            BlockTraits::deallocate(block_alloc, memory, 1);
+            throw;
+        }
+    }
+
+    Y* pointer() noexcept
+    { return std::launder(reinterpret_cast<Y*>(&m_storage)); }
+
+private:
+    template <class ... Args>
+    explicit inplace_control(const Alloc& alloc, Args&& ... args)
+        : compressed<Alloc>{alloc}
+    {
+        ObjectAlloc object_alloc{alloc};
+        ObjectTraits::construct(object_alloc,
+                                reinterpret_cast<Object*>(&m_storage),
+                                std::forward<Args>(args) ...);
+    }
+
+    void dispose() noexcept override
+    {
+        ObjectAlloc object_alloc{this->get()};
+        ObjectTraits::destroy(object_alloc, const_cast<Object*>(pointer()));
+    }
+
+    void destroy() noexcept override
+    {
+        using BlockPointer = typename BlockTraits::pointer;
+
+        BlockAlloc   block_alloc{this->get()};
+        BlockPointer memory = std::pointer_traits<BlockPointer>::pointer_to(*this);
+        this->~inplace_control();
+        BlockTraits::deallocate(block_alloc, memory, 1);
+    }
+
+    std::aligned_storage_t<sizeof(Y), StorageAlignment> m_storage;
+};
+
+// The block and the elements of an array are placed in one allocation,
+// which is obtained from the Alloc. The elements follow the block and
+// are aligned to the requested alignment, if it is greater than their own.
+template <class E, class Alloc, class Policy>
+class array_control final : public control<Policy>,
+                            private compressed<Alloc>
+{
+    using Element       = std::remove_cv_t<E>;
+    using ElementAlloc  = typename std::allocator_traits<Alloc>::template rebind_alloc<Element>;
+    using ElementTraits = std::allocator_traits<ElementAlloc>;
+
+    // The allocation is measured in the units of the fundamental alignment,
+    // so the block is aligned with any allocator.
+    struct alignas(std::max_align_t) unit
+    { unsigned char bytes[alignof(std::max_align_t)]; };
+
+    using UnitAlloc  = typename std::allocator_traits<Alloc>::template rebind_alloc<unit>;
+    using UnitTraits = std::allocator_traits<UnitAlloc>;
+
+    template <class A, class = void>
+    struct has_construct : std::false_type {};
+
+    template <class A>
+    struct has_construct<A, std::void_t<decltype(std::declval<A&>().construct(
+                                            std::declval<Element*>()))>>
+        : std::true_type {};
+
+    // Whether the allocator constructs the elements as the placement new does.
+    static constexpr bool IsPlainConstruct =
+           std::is_same_v<ElementAlloc, std::allocator<Element>>
+        || !has_construct<ElementAlloc>::value;
+
+public:
+    // Constructs the elements from the args, or default-initializes them
+    // if Overwrite is set.
+    template <bool Overwrite, class ... Args>
+    static array_control* create(const Alloc& alloc, std::size_t size,
+                                 std::size_t alignment, const Args& ... args)
+    {
+        UPL_STAT(itself_allocation, Policy::StatKind);
+
+        if (alignment < alignof(Element))
+            alignment = alignof(Element);
+
+        const std::size_t head = alignment < alignof(unit)
+                                 ? round_up(sizeof(array_control), alignment)
+                                 : round_up(sizeof(array_control), alignof(unit))
+                                   + (alignment - alignof(unit));
+
+        if (size > (std::size_t(-1) - head - sizeof(unit)) / sizeof(Element))
+            throw std::bad_array_new_length{};
+
+        const std::size_t units = (head + size * sizeof(Element) + sizeof(unit) - 1)
+                                  / sizeof(unit);
+
+        UnitAlloc unit_alloc{alloc};
+        auto      memory = UnitTraits::allocate(unit_alloc, units);
+        auto      start  = reinterpret_cast<unsigned char*>(std::addressof(*memory));
+        auto      first  = reinterpret_cast<Element*>(
+            round_up(reinterpret_cast<std::uintptr_t>(start + sizeof(array_control)),
+                     alignment));
+
+        auto block = ::new (static_cast<void*>(start))
+                     array_control{alloc, units, first};
+
+        std::size_t constructed = 0;
+        try
+        {
+            if constexpr (Overwrite)
+            {
+                std::uninitialized_default_construct_n(first, size);
+            }
+            else if constexpr (   IsPlainConstruct && sizeof ... (Args) == 0
+                               && std::is_arithmetic_v<Element>)
+            {
+                // The zero of a number is all zero bytes.
+                std::memset(static_cast<void*>(first), 0, size * sizeof(Element));
+            }
+            else
+            {
+                ElementAlloc element_alloc{alloc};
+                for (; constructed < size; ++constructed)
+                    ElementTraits::construct(element_alloc, first + constructed, args ...);
+            }
+        }
+        catch (...)
+        {
+            block->m_size = constructed;
+            block->dispose();
+            block->~array_control();
+            UnitTraits::deallocate(unit_alloc, memory, units);
+            throw;
+        }
+
+        block->m_size = size;
+        return block;
+    }
+
+    E* pointer() noexcept
+    { return m_elements; }
+
+private:
+    array_control(const Alloc& alloc, std::size_t units, Element* elements)
+        : compressed<Alloc>{alloc}, m_units{units}, m_elements{elements} {}
+
+    void dispose() noexcept override
+    {
+        ElementAlloc element_alloc{this->get()};
+        while (m_size != 0)
+            ElementTraits::destroy(element_alloc, m_elements + --m_size);
+    }
+
+    void destroy() noexcept override
+    {
+        using UnitPointer = typename UnitTraits::pointer;
+
+        UnitAlloc   unit_alloc{this->get()};
+        UnitPointer memory = std::pointer_traits<UnitPointer>::pointer_to(
+            *reinterpret_cast<unit*>(this));
+        const std::size_t units = m_units;
+        this->~array_control();
+        UnitTraits::deallocate(unit_alloc, memory, units);
+    }
+
+    static constexpr std::uintptr_t round_up(std::uintptr_t value, std::size_t alignment) noexcept
+    { return (value + alignment - 1) & ~std::uintptr_t{alignment - 1}; }
+
+    std::size_t m_units;
+    std::size_t m_size{0};
+    Element*    m_elements;
+};
+
+// The block owns an object that was allocated separately.
+template <class P, class D, class Policy>
+class pointer_control final : public control<Policy>,
+                              private compressed<D>
+{
+public:
+    pointer_control(P p, D d)
+        : compressed<D>{std::move(d)}, m_pointer{p} {}
+
+    void* deleter() noexcept override { return std::addressof(this->get()); }
+
+private:
+    void dispose() noexcept override { this->get()(m_pointer); }
+    void destroy() noexcept override { delete this; }
+
+    P m_pointer;
+};
+
+// The block keeps an object that is owned by the C++ Standard Library
+// smart pointers. The object stays reachable through the block while any
+// std::shared_ptr owns it.
+template <class Policy>
+class std_control final : public control<Policy>
+{
+    using parent = control<Policy>;
+
+public:
+    explicit std_control(std::shared_ptr<const void> owner) noexcept
+        : m_owner{std::move(owner)}, m_observer{m_owner} {}
+
+    explicit std_control(std::weak_ptr<const void> observer) noexcept
+        : parent{typename parent::observer_t{}}, m_observer{std::move(observer)} {}
+
+    const std::shared_ptr<const void>* std_owner() const noexcept override
+    { return m_owner ? &m_owner : nullptr; }
+
+    parent* relock() noexcept override
+    {
+        if (auto owner = m_observer.lock())
+            return new (std::nothrow) std_control{std::move(owner)};
+
+        return nullptr;
+    }
+
+private:
+    void dispose() noexcept override { m_owner.reset(); }
+    void destroy() noexcept override { delete this; }
+
+    bool has_external_owner() const noexcept override
+    { return !m_observer.expired(); }
+
+    std::shared_ptr<const void> m_owner;
+    std::weak_ptr<const void>   m_observer;
+};
+
+// The deleter of a std::shared_ptr that is created from a UPL pointer.
+// It holds one use of the UPL control block.
+struct std_releaser
+{
+    control<concurrent_policy>* block;
+
+    void operator()(const void*) const noexcept
+    { block->release(); }
+};
+
+} // namespace internal
+
+} // namespace detail
+
+} // namespace v0_2
+
+} // namespace upl
@@ -36,11 +36,12 @@ struct hash<upl::detail::internal::strong<T, Multiplicity>>
     using element_type = typename pointer_type::element_type;
 
     using argument_type = pointer_type;
-    using result_type   = typename hash<element_type*>::result_type;
+    using result_type   = std::size_t;
 
+    // The address is mixed, so the hash suits the open addressing.
     result_type operator()(const pointer_type& pointer) const noexcept
     {
-        return hash<element_type*>()(pointer.get());
+        return upl::detail::internal::hash_address(pointer.get());
     }
 };
 
@@ -52,6 +53,22 @@ template <class T, class Multiplicity>
 struct hash<upl::detail::unique<T, Multiplicity>>
     : public hash<upl::detail::internal::strong<T, Multiplicity>> {};
 
+template <class T, class Multiplicity, class Deleter>
+struct hash<upl::detail::custom_unique<T, Multiplicity, Deleter>>
+{
+    using pointer_type = upl::detail::custom_unique<T, Multiplicity, Deleter>;
+    using element_type = typename pointer_type::element_type;
+
+    using argument_type = pointer_type;
+    using result_type   = std::size_t;
+
+    // Hashed as the strong pointers, so the equal pointers hash equally.
+    result_type operator()(const pointer_type& pointer) const noexcept
+    {
+        return upl::detail::internal::hash_address(pointer.get());
+    }
+};
+
 template <class T, class Multiplicity>
 struct hash<upl::detail::shared<T, Multiplicity>>
     : public hash<upl::detail::internal::strong<T, Multiplicity>> {};
@@ -0,0 +1,361 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018-2019 Viktor Kireev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace upl
+{
+
+inline namespace v0_2
+{
+
+namespace detail
+{
+
+namespace internal
+{
+
+// The hazard pointers let a reader use an object without changing
+// its counts, so the readers of one object do not write to a shared cache line.
+//
+// A reader publishes the control block in a slot of its thread and then
+// checks that the object is still owned. The owner that releases the object
+// last looks through the slots, and if the block is published there,
+// the destruction is deferred: the block goes to the retired list, and
+// the records of its readers are marked. The reader that unprotects a slot
+// of a marked record reclaims the retired entries that are not protected
+// anymore, so an entry usually outlives only its last reader. So the readers
+// write only their own records, and take a lock only to reclaim.
+//
+// The mark is not ordered with the unprotect: a reader that unprotects
+// the block while it is being retired may miss the mark. Then the entry
+// waits for the next reclaim, which is made by any later retirement,
+// unprotect of a marked record, the last unpin, the exit of a thread
+// or the reclaim().
+class hazard
+{
+public:
+    using Reclaim = void (*)(const void*) noexcept;
+
+    // The depth of the nested protections of one thread.
+    static constexpr std::size_t Slots = 4;
+
+    using slot = std::atomic<const void*>;
+
+    // Publishes the p, returns its slot or nullptr if the thread
+    // has no free slot.
+    static slot* protect(const void* p) noexcept
+    {
+        record* r = this_thread_record();
+        if (r == nullptr || r->depth == Slots)
+            return nullptr;
+
+        slot* s = &r->slots[r->depth++];
+        s->exchange(p, std::memory_order_seq_cst);
+        return s;
+    }
+
+    static void unprotect(slot* s) noexcept
+    {
+        s->store(nullptr, std::memory_order_release);
+
+        record* r = t_record;
+        --r->depth;
+        if (   r->marked.load(std::memory_order_relaxed)
+            && r->marked.exchange(false, std::memory_order_acq_rel))
+            collect();
+    }
+
+    // Like the protect, but if the thread has no free slot, pins all
+    // the objects until the unpin, so it never fails.
+    static slot* protect_or_pin(const void* p) noexcept
+    {
+        if (slot* s = protect(p))
+            return s;
+
+        pins().fetch_add(1, std::memory_order_seq_cst);
+        return nullptr;
+    }
+
+    static void unprotect_or_unpin(slot* s) noexcept
+    {
+        if (s != nullptr)
+        {
+            unprotect(s);
+            return;
+        }
+
+        if (   pins().fetch_sub(1, std::memory_order_acq_rel) == 1
+            && retired().load(std::memory_order_relaxed) != 0)
+            collect();
+    }
+
+    static bool is_protected(const void* p) noexcept
+    { return find(p, false); }
+
+    // Is called after the object has become unreachable for new readers
+    // by a sequentially consistent operation. Returns false if no reader
+    // protects the p, so it can be reclaimed at once, otherwise the reclaim
+    // is deferred until its readers unprotect it.
+    static bool defer(const void* p, Reclaim reclaim_p) noexcept
+    {
+        if (!find(p, true))
+            return false;
+
+        try
+        {
+            registry&                   g = records();
+            std::lock_guard<std::mutex> lock{g.mutex};
+            g.retired.push_back({p, reclaim_p});
+            retired().fetch_add(1, std::memory_order_seq_cst);
+        }
+        catch (...)
+        {
+            wait(p);
+            return false;
+        }
+
+        // A reader that has unprotected the p meanwhile may have missed
+        // the mark.
+        if (!is_protected(p))
+            collect();
+
+        return true;
+    }
+
+    // Reclaims the retired entries that are not protected anymore.
+    static void reclaim() noexcept
+    { collect(); }
+
+private:
+    struct entry
+    {
+        const void* pointer;
+        Reclaim     reclaim;
+    };
+
+    // The slots are written by the owning thread and read by the others,
+    // the mark is set by the others when they retire a published object.
+    struct alignas(64) record
+    {
+        slot              slots[Slots]{};
+        std::atomic<bool> marked{false};
+        std::size_t       depth{0};
+        bool              in_use{false};
+        record*           next{nullptr};
+    };
+
+    // The records are never destroyed, so they can be looked through
+    // without a lock. The retired list is not destroyed either, so
+    // the objects that are released at the exit are still reclaimed.
+    struct registry
+    {
+        std::mutex           mutex;
+        std::atomic<record*> head{nullptr};
+        std::vector<entry>   retired;
+    };
+
+    static registry& records() noexcept
+    {
+        static registry* instance = new registry;
+        return *instance;
+    }
+
+    static std::atomic<std::size_t>& pins() noexcept
+    {
+        static std::atomic<std::size_t> instance{0};
+        return instance;
+    }
+
+    // The number of the retired entries.
+    static std::atomic<std::size_t>& retired() noexcept
+    {
+        static std::atomic<std::size_t> instance{0};
+        return instance;
+    }
+
+    // Whether a reader publishes the p. The records that publish it are
+    // marked, if it is asked for, so their readers reclaim the p.
+    static bool find(const void* p, bool mark) noexcept
+    {
+        if (pins().load(std::memory_order_seq_cst) != 0)
+            return true;
+
+        bool found = false;
+        for (record* r = records().head.load(std::memory_order_acquire);
+             r != nullptr; r = r->next)
+        {
+            for (const slot& s : r->slots)
+            {
+                if (s.load(std::memory_order_seq_cst) == p)
+                {
+                    if (!mark)
+                        return true;
+
+                    r->marked.store(true, std::memory_order_seq_cst);
+                    found = true;
+                    break;
+                }
+            }
+        }
+
+        return found;
+    }
+
+    static void wait(const void* p) noexcept
+    {
+        while (is_protected(p))
+            std::this_thread::yield();
+    }
+
+    // Only one thread scans the retired list, the others ask it to scan
+    // again, so an entry that is unprotected during a scan is not missed.
+    static void collect() noexcept
+    {
+        static std::atomic<bool> scanning{false};
+        static std::atomic<bool> requested{false};
+
+        requested.store(true, std::memory_order_seq_cst);
+        while (   requested.load(std::memory_order_seq_cst)
+               && !scanning.exchange(true, std::memory_order_seq_cst))
+        {
+            requested.store(false, std::memory_order_seq_cst);
+            scan();
+            scanning.store(false, std::memory_order_seq_cst);
+        }
+    }
+
+    // A reclaimed object may release other visited objects, which are
+    // appended to the list meanwhile, so the entries are taken out one by
+    // one and reclaimed without the lock.
+    static void scan() noexcept
+    {
+        registry&   g = records();
+        std::size_t i = 0;
+        for (;;)
+        {
+            entry e{};
+            {
+                std::lock_guard<std::mutex> lock{g.mutex};
+                while (i < g.retired.size() && find(g.retired[i].pointer, true))
+                    ++i;
+
+                if (i == g.retired.size())
+                    return;
+
+                e = g.retired[i];
+                g.retired[i] = g.retired.back();
+                g.retired.pop_back();
+            }
+
+            retired().fetch_sub(1, std::memory_order_relaxed);
+            e.reclaim(e.pointer);
+        }
+    }
+
+    // The record is taken once per thread, so the lock is not on the way
+    // of the readers.
+    static record* acquire_record()
+    {
+        registry&                   r = records();
+        std::lock_guard<std::mutex> lock{r.mutex};
+
+        for (record* c = r.head.load(std::memory_order_relaxed); c != nullptr; c = c->next)
+        {
+            if (!c->in_use)
+            {
+                c->in_use = true;
+                return c;
+            }
+        }
+
+        record* c = new record;
+        c->in_use = true;
+        c->next   = r.head.load(std::memory_order_relaxed);
+        r.head.store(c, std::memory_order_release);
+        return c;
+    }
+
+    static void release_record(record* c) noexcept
+    {
+        registry&                   r = records();
+        std::lock_guard<std::mutex> lock{r.mutex};
+        c->in_use = false;
+    }
+
+    enum class state : unsigned char { fresh, alive, finished };
+
+    // A finishing thread reclaims what its readers have left.
+    struct thread_guard
+    {
+        ~thread_guard()
+        {
+            if (retired().load(std::memory_order_relaxed) != 0)
+                collect();
+
+            t_state = state::finished;
+            release_record(std::exchange(t_record, nullptr));
+        }
+    };
+
+    static record* this_thread_record() noexcept
+    {
+        if (t_state == state::alive)
+            return t_record;
+
+        if (t_state == state::finished)
+            return nullptr;
+
+        try
+        {
+            t_record = acquire_record();
+        }
+        catch (...)
+        {
+            return nullptr;
+        }
+
+        t_state = state::alive;
+        static thread_local thread_guard guard;
+        return t_record;
+    }
+
+    static inline thread_local state   t_state{state::fresh};
+    static inline thread_local record* t_record{nullptr};
+};
+
+} // namespace internal
+
+} // namespace detail
+
+} // namespace v0_2
+
+} // namespace upl
@@ -0,0 +1,780 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018-2019 Viktor Kireev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <upl/v0_2/utility/intrusive_base.h>
+
+#include "referrer.h"
+
+#include <algorithm>
+#include <cassert>
+#include <thread>
+
+namespace upl
+{
+
+inline namespace v0_2
+{
+
+namespace detail
+{
+
+namespace internal
+{
+
+// Counts the references inside the objects derived from the intrusive_base.
+struct intrusive_policy
+{
+    static constexpr stats::kind StatKind = stats::kind::intrusive;
+};
+
+// Describes how an intrusive object is destroyed. The description is
+// kept by the object, so it costs the object one pointer.
+struct intrusive_destruction
+{
+    void (*destroy)(const intrusive_base* object) noexcept;
+    void*  deleter;
+};
+
+// Counts the weak references to an intrusive object. It is created by
+// the first weak pointer, since the object itself can't outlive its owners.
+// The block is only the liveness flag of the object: a weak pointer
+// enters the block while it touches the counts of the object, and the last
+// owner clears the flag and waits for the entered ones before destroying
+// the object. So the lock is a CAS on the counts of the object itself.
+class intrusive_weak_block
+{
+public:
+    explicit intrusive_weak_block(const intrusive_base* object) noexcept
+        : m_object{object} {}
+
+    void add_weak() noexcept
+    { m_weaks.fetch_add(1, std::memory_order_relaxed); }
+
+    void release_weak() noexcept
+    {
+        if (m_weaks.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            delete this;
+    }
+
+    const intrusive_base* lock() noexcept;
+    bool expired() noexcept;
+    long use_count() noexcept;
+    void detach() noexcept;
+
+    const void* key() const noexcept { return m_object; }
+
+private:
+    static constexpr std::uint32_t Alive   = 1;
+    static constexpr std::uint32_t Entered = 2;
+
+    // Whether the object may be touched until the leave().
+    bool enter() noexcept
+    { return m_state.fetch_add(Entered, std::memory_order_acquire) & Alive; }
+
+    void leave() noexcept
+    { m_state.fetch_sub(Entered, std::memory_order_release); }
+
+    // The alive object holds one weak reference.
+    std::atomic<std::uint32_t> m_weaks{1};
+    std::atomic<std::uint32_t> m_state{Alive};
+    const intrusive_base*      m_object;
+};
+
+class intrusive_access
+{
+public:
+    using Destroy = intrusive_base::Destroy;
+
+    // An object that is already owned keeps its way of destruction.
+    static void adopt(const intrusive_base* object, Destroy destroy) noexcept
+    {
+        if (object->m_uses.load(std::memory_order_relaxed) != 0)
+            return add_use(object);
+
+        object->m_destroy = destroy;
+        object->m_uses.store(1, std::memory_order_relaxed);
+    }
+
+    // The 'unique' owner can't share the object with the existing owners.
+    static void adopt_unique(const intrusive_base* object, Destroy destroy) noexcept
+    {
+        assert(object->m_uses.load(std::memory_order_relaxed) == 0
+               && "an owned intrusive object can't get a 'unique' owner");
+        adopt(object, destroy);
+    }
+
+    static void add_use(const intrusive_base* object) noexcept
+    {
+        UPL_STAT(add_use, stats::kind::intrusive);
+        object->m_uses.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    static bool try_add_use(const intrusive_base* object) noexcept
+    {
+        auto uses = object->m_uses.load(std::memory_order_relaxed);
+        do
+        {
+            if (uses == 0)
+                return false;
+        }
+        while (!object->m_uses.compare_exchange_weak(uses, uses + 1,
+                                                     std::memory_order_acq_rel,
+                                                     std::memory_order_relaxed));
+        UPL_STAT(add_use, stats::kind::intrusive);
+        return true;
+    }
+
+    static void* deleter(const intrusive_base* object) noexcept
+    { return object->m_destroy->deleter; }
+
+    static std::uint32_t use_count(const intrusive_base* object) noexcept
+    { return object->m_uses.load(std::memory_order_acquire); }
+
+    static void release(const intrusive_base* object) noexcept
+    {
+        UPL_STAT(release, stats::kind::intrusive);
+
+        // The sole owner without observers is released without
+        // a read-modify-write, nobody else can refer to the object.
+        if (   (   object->m_uses.load(std::memory_order_acquire) != 1
+                || object->m_weak.load(std::memory_order_acquire) != nullptr)
+            && object->m_uses.fetch_sub(1, std::memory_order_acq_rel) != 1)
+            return;
+
+        if (auto block = object->m_weak.load(std::memory_order_acquire))
+            block->detach();
+
+        object->m_destroy->destroy(object);
+    }
+
+    // The caller owns the object, so it can't die meanwhile.
+    static intrusive_weak_block* weak_block(const intrusive_base* object)
+    {
+        auto block = object->m_weak.load(std::memory_order_acquire);
+        if (block)
+            return block;
+
+        auto created = new intrusive_weak_block{object};
+        if (object->m_weak.compare_exchange_strong(block, created,
+                                                   std::memory_order_acq_rel,
+                                                   std::memory_order_acquire))
+            return created;
+
+        delete created;
+        return block;
+    }
+};
+
+inline const intrusive_base* intrusive_weak_block::lock() noexcept
+{
+    const bool locked = enter() && intrusive_access::try_add_use(m_object);
+    leave();
+    return locked ? m_object : nullptr;
+}
+
+inline bool intrusive_weak_block::expired() noexcept
+{
+    const bool expired = !enter() || intrusive_access::use_count(m_object) == 0;
+    leave();
+    return expired;
+}
+
+inline long intrusive_weak_block::use_count() noexcept
+{
+    const long count = enter() ? long(intrusive_access::use_count(m_object)) : 0;
+    leave();
+    return count;
+}
+
+// The object has no owners, so the entered weak pointers only fail
+// to lock it and leave at once.
+inline void intrusive_weak_block::detach() noexcept
+{
+    m_state.fetch_and(~Alive, std::memory_order_acq_rel);
+    while (m_state.load(std::memory_order_acquire) != 0)
+        std::this_thread::yield();
+
+    release_weak();
+}
+
+template <class Y, class = void>
+inline constexpr bool IsIntrusiveDowncast = false;
+
+template <class Y>
+inline constexpr bool IsIntrusiveDowncast<
+    Y, std::void_t<decltype(static_cast<Y*>(std::declval<const intrusive_base*>()))>> = true;
+
+template <class Y>
+inline const intrusive_base* intrusive_cast(Y* p) noexcept
+{
+    static_assert(std::is_convertible_v<Y*, const intrusive_base*>,
+                  "the intrusive pointers refer only to objects "
+                  "derived from the upl::intrusive_base");
+    static_assert(IsIntrusiveDowncast<const std::remove_cv_t<Y>>,
+                  "the upl::intrusive_base must be a non-virtual base "
+                  "of the object, since the object is found by the downcast "
+                  "from it");
+    return p;
+}
+
+template <class Y, class D>
+inline void intrusive_delete(const intrusive_base* object) noexcept
+{ D{}(static_cast<Y*>(const_cast<intrusive_base*>(object))); }
+
+// A stateless deleter is made anew by the intrusive_delete, and
+// the description keeps the one that is given out as the deleter
+// of its objects.
+template <class Y, class D>
+inline D IntrusiveDeleter{};
+
+template <class Y, class D>
+inline constexpr intrusive_destruction IntrusiveDelete =
+    {&intrusive_delete<Y, D>, &IntrusiveDeleter<Y, D>};
+
+// The object is placed at the beginning of an allocation, which is obtained
+// from the Alloc. A stateful allocator is kept behind the object.
+template <class Y, class Alloc>
+class intrusive_storage
+{
+    using Object = std::remove_cv_t<Y>;
+
+    static constexpr bool IsStateless = std::is_empty_v<Alloc>
+                                        && std::is_default_constructible_v<Alloc>;
+
+    static constexpr std::size_t AllocOffset =
+        (sizeof(Object) + alignof(Alloc) - 1) / alignof(Alloc) * alignof(Alloc);
+    static constexpr std::size_t Size =
+        IsStateless ? sizeof(Object) : AllocOffset + sizeof(Alloc);
+    static constexpr std::size_t Align = std::max(alignof(Object), alignof(Alloc));
+
+    struct alignas(Align) unit { unsigned char bytes[Align]; };
+
+    static constexpr std::size_t Count = (Size + Align - 1) / Align;
+
+    using ObjectAlloc  = typename std::allocator_traits<Alloc>::template rebind_alloc<Object>;
+    using ObjectTraits = std::allocator_traits<ObjectAlloc>;
+    using UnitAlloc    = typename std::allocator_traits<Alloc>::template rebind_alloc<unit>;
+    using UnitTraits   = std::allocator_traits<UnitAlloc>;
+
+public:
+    template <class ... Args>
+    static Y* create(const Alloc& alloc, Args&& ... args)
+    {
+        UPL_STAT(itself_allocation, stats::kind::intrusive);
+
+        UnitAlloc unit_alloc{alloc};
+        auto      memory  = UnitTraits::allocate(unit_alloc, Count);
+        auto      address = static_cast<void*>(std::addressof(*memory));
+        try
+        {
+            ObjectAlloc object_alloc{alloc};
+            ObjectTraits::construct(object_alloc, static_cast<Object*>(address),
+                                    std::forward<Args>(args) ...);
+        }
+        catch (...)
+        {
+            UnitTraits::deallocate(unit_alloc, memory, Count);
+            throw;
+        }
+
+        if constexpr (!IsStateless)
+            ::new (static_cast<unsigned char*>(address) + AllocOffset) Alloc{alloc};
+
+        return std::launder(static_cast<Object*>(address));
+    }
+
+    static void destroy(const intrusive_base* base) noexcept
+    {
+        using UnitPointer = typename UnitTraits::pointer;
+
+        auto object  = const_cast<Object*>(static_cast<const Object*>(base));
+        auto address = static_cast<void*>(object);
+        auto alloc   = take_allocator(static_cast<unsigned char*>(address));
+
+        ObjectAlloc object_alloc{alloc};
+        ObjectTraits::destroy(object_alloc, object);
+
+        UnitAlloc unit_alloc{alloc};
+        UnitTraits::deallocate(unit_alloc,
+                               std::pointer_traits<UnitPointer>::pointer_to(
+                                   *static_cast<unit*>(address)),
+                               Count);
+    }
+
+    static constexpr intrusive_destruction Destruction = {&destroy, nullptr};
+
+private:
+    static Alloc take_allocator(unsigned char* address) noexcept
+    {
+        if constexpr (IsStateless)
+        {
+            return Alloc{};
+        }
+        else
+        {
+            auto  stored = std::launder(reinterpret_cast<Alloc*>(address + AllocOffset));
+            Alloc alloc{std::move(*stored)};
+            stored->~Alloc();
+            return alloc;
+        }
+    }
+};
+
+// Keeps one use of an intrusive object for the std::shared_ptr.
+struct intrusive_releaser
+{
+    const intrusive_base* object;
+
+    void operator()(const void*) const noexcept
+    { intrusive_access::release(object); }
+};
+
+// Holds one use of an intrusive object.
+template <class T>
+class strong_referrer<T, intrusive_policy>
+{
+public:
+    using element_type = std::remove_extent_t<T>;
+
+    constexpr strong_referrer() noexcept = default;
+
+    template <class Y, class ... Args>
+    explicit strong_referrer(itself_type_t<Y> itself, Args&& ... args)
+        : strong_referrer{std::allocator_arg, default_allocator<Y>{},
+                          itself, std::forward<Args>(args) ...} {}
+
+    template <class Alloc, class Y, class ... Args>
+    strong_referrer(std::allocator_arg_t, const Alloc& alloc,
+                    itself_type_t<Y>, Args&& ... args)
+    {
+        using Storage = intrusive_storage<Y, allocator_t<Alloc>>;
+
+        auto object = Storage::create(allocator_t<Alloc>{alloc},
+                                      std::forward<Args>(args) ...);
+        intrusive_access::adopt(intrusive_cast(object), &Storage::Destruction);
+        m_pointer = object;
+    }
+
+    template <class ... Args>
+    strong_referrer(itself_isolated_t, Args&& ...)
+    {
+        static_assert(sizeof(T) == -1,
+                      "the counts of an intrusive object are a part of it");
+    }
+
+    template <class Alloc, class ... Args>
+    strong_referrer(std::allocator_arg_t, const Alloc&, itself_isolated_t, Args&& ...)
+    {
+        static_assert(sizeof(T) == -1,
+                      "the counts of an intrusive object are a part of it");
+    }
+
+    template <class Y>
+    explicit strong_referrer(Y* p) noexcept
+        : strong_referrer{p, std::default_delete<Y>{}} {}
+
+    template <class Y, class D>
+    strong_referrer(Y* p, D) noexcept
+    {
+        static_assert(std::is_empty_v<D> && std::is_default_constructible_v<D>,
+                      "an intrusive object can be taken only with "
+                      "a stateless deleter");
+
+        if (p == nullptr)
+            return;
+
+        intrusive_access::adopt(intrusive_cast(p), &IntrusiveDelete<Y, D>);
+        m_pointer = p;
+    }
+
+    // The object of a 'unique' owner must not be owned yet.
+    template <class Y, class D>
+    strong_referrer(bare_t, Y* p, D) noexcept
+    {
+        static_assert(std::is_empty_v<D> && std::is_default_constructible_v<D>,
+                      "an intrusive object can be taken only with "
+                      "a stateless deleter");
+
+        if (p == nullptr)
+            return;
+
+        intrusive_access::adopt_unique(intrusive_cast(p), &IntrusiveDelete<Y, D>);
+        m_pointer = p;
+    }
+
+    template <class Y>
+    strong_referrer(bare_t, Y* p) noexcept
+        : strong_referrer{bare_t{}, p, std::default_delete<Y>{}} {}
+
+    template <class Y, class D>
+    strong_referrer(bare_t, std::unique_ptr<Y, D>&& other) noexcept
+        : strong_referrer{bare_t{}, other.get(), D{}}
+    { other.release(); }
+
+    template <class Y, class D>
+    strong_referrer(std::unique_ptr<Y, D>&& other) noexcept
+    {
+        static_assert(std::is_same_v<typename std::unique_ptr<Y, D>::pointer, Y*>
+                      && std::is_empty_v<D>
+                      && std::is_default_constructible_v<D>,
+                      "an intrusive object can be taken only with "
+                      "a stateless deleter");
+
+        if (!other)
+            return;
+
+        intrusive_access::adopt(intrusive_cast(other.get()),
+                                &IntrusiveDelete<Y, D>);
+        m_pointer = other.release();
+    }
+
+    template <class Y>
+    strong_referrer(const std::shared_ptr<Y>& other)
+    {
+        static_assert(sizeof(Y) == -1,
+                      "an intrusive object can't be taken from the std::shared_ptr");
+    }
+
+    template <class Y>
+    explicit strong_referrer(const std::weak_ptr<Y>& other)
+    {
+        static_assert(sizeof(Y) == -1,
+                      "an intrusive object can't be taken from the std::weak_ptr");
+    }
+
+    strong_referrer(const strong_referrer& other) noexcept
+        : m_pointer{other.m_pointer}
+    {
+        if (m_pointer)
+            intrusive_access::add_use(intrusive_cast(m_pointer));
+    }
+
+    template <class Y>
+    strong_referrer(const strong_referrer<Y, intrusive_policy>& other) noexcept
+        : m_pointer{other.m_pointer}
+    {
+        if (m_pointer)
+            intrusive_access::add_use(intrusive_cast(m_pointer));
+    }
+
+    template <class Y, class P>
+    strong_referrer(const strong_referrer<Y, P>& other) = delete;
+
+    strong_referrer(strong_referrer&& other) noexcept
+        : m_pointer{std::exchange(other.m_pointer, nullptr)} {}
+
+    template <class Y>
+    strong_referrer(strong_referrer<Y, intrusive_policy>&& other) noexcept
+        : m_pointer{std::exchange(other.m_pointer, nullptr)} {}
+
+    template <class Y, class P>
+    strong_referrer(strong_referrer<Y, P>&& other) = delete;
+
+    // Refer to the object of the other by its cast pointer p, which keeps
+    // the counts of the object.
+    template <class Y>
+    strong_referrer(const strong_referrer<Y, intrusive_policy>& other, element_type* p) noexcept
+        : m_pointer{p}
+    {
+        assert(key() == other.key());
+
+        if (m_pointer)
+            intrusive_access::add_use(intrusive_cast(m_pointer));
+    }
+
+    template <class Y>
+    strong_referrer(strong_referrer<Y, intrusive_policy>&& other, element_type* p) noexcept
+        : m_pointer{p}
+    {
+        assert(key() == other.key());
+        other.m_pointer = nullptr;
+    }
+
+    ~strong_referrer()
+    {
+        if (m_pointer)
+            intrusive_access::release(intrusive_cast(m_pointer));
+    }
+
+    strong_referrer& operator=(const strong_referrer& other) noexcept
+    {
+        strong_referrer{other}.swap(*this);
+        return *this;
+    }
+
+    strong_referrer& operator=(strong_referrer&& other) noexcept
+    {
+        strong_referrer{std::move(other)}.swap(*this);
+        return *this;
+    }
+
+    element_type* get() const noexcept { return m_pointer; }
+
+    explicit operator bool() const noexcept { return m_pointer != nullptr; }
+
+    void reset() noexcept { strong_referrer{}.swap(*this); }
+
+    void swap(strong_referrer& other) noexcept
+    { std::swap(m_pointer, other.m_pointer); }
+
+    template <class U>
+    bool owner_before(const strong_referrer<U, intrusive_policy>& other) const noexcept
+    { return std::less<const void*>()(key(), other.key()); }
+
+    template <class U>
+    bool owner_before(const weak_referrer<U, intrusive_policy>& other) const noexcept
+    { return std::less<const void*>()(key(), other.key()); }
+
+    template <class U>
+    bool owner_equal(const strong_referrer<U, intrusive_policy>& other) const noexcept
+    { return key() == other.key(); }
+
+    template <class U>
+    bool owner_equal(const weak_referrer<U, intrusive_policy>& other) const noexcept
+    { return key() == other.key(); }
+
+    std::size_t owner_hash() const noexcept
+    { return hash_address(key()); }
+
+    long use_count() const noexcept
+    { return m_pointer ? long(intrusive_access::use_count(intrusive_cast(m_pointer))) : 0; }
+
+    // The deleter of the object, which is kept by its description.
+    void* deleter() const noexcept
+    { return m_pointer ? intrusive_access::deleter(intrusive_cast(m_pointer)) : nullptr; }
+
+    std::shared_ptr<T> share() const &
+    {
+        if (!m_pointer)
+            return std::shared_ptr<T>{};
+
+        intrusive_access::add_use(intrusive_cast(m_pointer));
+        return std::shared_ptr<T>{m_pointer,
+                                  intrusive_releaser{intrusive_cast(m_pointer)}};
+    }
+
+    std::shared_ptr<T> share() &&
+    {
+        if (!m_pointer)
+            return std::shared_ptr<T>{};
+
+        auto p = std::exchange(m_pointer, nullptr);
+        return std::shared_ptr<T>{p, intrusive_releaser{intrusive_cast(p)}};
+    }
+
+private:
+    struct adopted_t {};
+
+    strong_referrer(adopted_t, element_type* p) noexcept : m_pointer{p} {}
+
+    const void* key() const noexcept
+    { return m_pointer ? intrusive_cast(m_pointer) : nullptr; }
+
+    template <class Y, class P>
+    friend class strong_referrer;
+    template <class Y, class P>
+    friend class weak_referrer;
+
+    element_type* m_pointer{nullptr};
+};
+
+// Holds one weak reference to an intrusive object.
+template <class T>
+class weak_referrer<T, intrusive_policy>
+{
+public:
+    using element_type = std::remove_extent_t<T>;
+
+    constexpr weak_referrer() noexcept = default;
+
+    template <class Y>
+    weak_referrer(const strong_referrer<Y, intrusive_policy>& other)
+    {
+        if (!other.m_pointer)
+            return;
+
+        m_block = intrusive_access::weak_block(intrusive_cast(other.m_pointer));
+        m_block->add_weak();
+    }
+
+    template <class Y, class P>
+    weak_referrer(const strong_referrer<Y, P>& other) = delete;
+
+    template <class Y>
+    weak_referrer(const std::shared_ptr<Y>& other)
+    {
+        static_assert(sizeof(Y) == -1,
+                      "an intrusive object can't be observed through the std::shared_ptr");
+    }
+
+    template <class Y>
+    weak_referrer(const std::weak_ptr<Y>& other)
+    {
+        static_assert(sizeof(Y) == -1,
+                      "an intrusive object can't be observed through the std::weak_ptr");
+    }
+
+    template <class Other>
+    weak_referrer(Other&& other, element_type* p)
+    {
+        static_assert(sizeof(Other) == -1,
+                      "an intrusive object can't be aliased");
+    }
+
+    weak_referrer(const weak_referrer& other) noexcept
+        : m_block{other.m_block}
+    {
+        if (m_block)
+            m_block->add_weak();
+    }
+
+    template <class Y>
+    weak_referrer(const weak_referrer<Y, intrusive_policy>& other) noexcept
+        : m_block{other.m_block}
+    {
+        if (m_block)
+            m_block->add_weak();
+    }
+
+    template <class Y, class P>
+    weak_referrer(const weak_referrer<Y, P>& other) = delete;
+
+    weak_referrer(weak_referrer&& other) noexcept
+        : m_block{std::exchange(other.m_block, nullptr)} {}
+
+    template <class Y>
+    weak_referrer(weak_referrer<Y, intrusive_policy>&& other) noexcept
+        : m_block{std::exchange(other.m_block, nullptr)} {}
+
+    template <class Y, class P>
+    weak_referrer(weak_referrer<Y, P>&& other) = delete;
+
+    ~weak_referrer()
+    {
+        if (m_block)
+            m_block->release_weak();
+    }
+
+    weak_referrer& operator=(const weak_referrer& other) noexcept
+    {
+        weak_referrer{other}.swap(*this);
+        return *this;
+    }
+
+    weak_referrer& operator=(weak_referrer&& other) noexcept
+    {
+        weak_referrer{std::move(other)}.swap(*this);
+        return *this;
+    }
+
+    bool expired() const noexcept
+    { return m_block == nullptr || m_block->expired(); }
+
+    // The block refers to the intrusive_base of the object, which is
+    // a base of the T, so the T is obtained by the downcast.
+    strong_referrer<T, intrusive_policy> lock() const & noexcept
+    {
+        using Strong = strong_referrer<T, intrusive_policy>;
+
+        UPL_STAT(lock, stats::kind::intrusive);
+
+        if (m_block)
+        {
+            if (auto object = m_block->lock())
+                return Strong{typename Strong::adopted_t{},
+                              static_cast<element_type*>(
+                                  const_cast<intrusive_base*>(object))};
+        }
+
+        UPL_STAT(lock_failure, stats::kind::intrusive);
+        return Strong{};
+    }
+
+    // The weak block is released after the lock, since the object and
+    // the block are counted apart.
+    strong_referrer<T, intrusive_policy> lock() && noexcept
+    {
+        auto result = static_cast<const weak_referrer&>(*this).lock();
+        reset();
+        return result;
+    }
+
+    template <class SuccessAction, class FailureAction>
+    auto visit(SuccessAction&& success_action,
+               FailureAction&& failure_action) const
+    {
+        if (auto p = lock())
+            return success_action(*p.get());
+
+        return failure_action();
+    }
+
+    void reset() noexcept { weak_referrer{}.swap(*this); }
+
+    void swap(weak_referrer& other) noexcept
+    { std::swap(m_block, other.m_block); }
+
+    template <class U>
+    bool owner_before(const weak_referrer<U, intrusive_policy>& other) const noexcept
+    { return std::less<const void*>()(key(), other.key()); }
+
+    template <class U>
+    bool owner_equal(const strong_referrer<U, intrusive_policy>& other) const noexcept
+    { return key() == other.key(); }
+
+    template <class U>
+    bool owner_equal(const weak_referrer<U, intrusive_policy>& other) const noexcept
+    { return key() == other.key(); }
+
+    std::size_t owner_hash() const noexcept
+    { return hash_address(key()); }
+
+    long use_count() const noexcept
+    { return m_block ? m_block->use_count() : 0; }
+
+    template <class U>
+    bool owner_before(const strong_referrer<U, intrusive_policy>& other) const noexcept
+    { return std::less<const void*>()(key(), other.key()); }
+
+private:
+    const void* key() const noexcept
+    { return m_block ? m_block->key() : nullptr; }
+
+    template <class Y, class P>
+    friend class strong_referrer;
+    template <class Y, class P>
+    friend class weak_referrer;
+
+    intrusive_weak_block* m_block{nullptr};
+};
+
+} // namespace internal
+
+} // namespace detail
+
+} // namespace v0_2
+
+} // namespace upl
@@ -28,17 +28,37 @@
 #include <upl/v0_2/exception.h>
 #include <upl/v0_2/utility/itself.h>
 
+#include "intrusive.h"
+#include "referrer.h"
+#include "slot.h"
 #include "utility/concept.h"
 
+#include <cstddef>
 #include <memory>
 #include <cassert>
 
+// The 'single' pointers are not null by construction. Only a moved-from one
+// is null, and it may only be assigned to or destroyed. In the checked mode,
+// which is the default unless NDEBUG is defined, the other uses of
+// a moved-from 'single' throw the single_error; otherwise they are
+// undefined, and the access to a 'single' is a plain load.
+#if !defined (UPL_CHECKED_SINGLE)
+#if defined (NDEBUG)
+#define UPL_CHECKED_SINGLE 0
+#else
+#define UPL_CHECKED_SINGLE 1
+#endif
+#endif
+
 namespace upl
 {
 
 inline namespace v0_2
 {
 
+template <class T, class Multiplicity>
+class enable_weak_from_this;
+
 namespace detail
 {
 
@@ -65,17 +85,46 @@ inline constexpr bool IsConstIncorrect =
 
 template <class Multiplicity>
 inline constexpr bool IsOptional =
-    std::is_same_v<Multiplicity, tag::optional>;
+    std::is_base_of_v<tag::optional, Multiplicity>;
 
 template <class Multiplicity>
 inline constexpr bool IsSingle =
-    std::is_same_v<Multiplicity, tag::single>;
+    std::is_base_of_v<tag::single, Multiplicity>;
+
+inline constexpr bool CheckedSingle = UPL_CHECKED_SINGLE;
+
+template <class Multiplicity>
+inline constexpr bool IsLocal =
+    std::is_base_of_v<upl::internal::tag::local, Multiplicity>;
+
+template <class Multiplicity>
+inline constexpr bool IsIntrusive =
+    std::is_base_of_v<upl::internal::tag::intrusive, Multiplicity>;
+
+template <class Multiplicity>
+inline constexpr bool IsSlot =
+    std::is_base_of_v<upl::internal::tag::slot, Multiplicity>;
+
+// The 'optional' multiplicity with the same ownership policy.
+template <class Multiplicity>
+using Optional =
+    std::conditional_t<IsLocal<Multiplicity>, tag::local::optional,
+    std::conditional_t<IsIntrusive<Multiplicity>, tag::intrusive::optional,
+    std::conditional_t<IsSlot<Multiplicity>, tag::slot::optional,
+                       tag::optional>>>;
+
+template <class Multiplicity>
+using Policy =
+    std::conditional_t<IsLocal<Multiplicity>, local_policy,
+    std::conditional_t<IsIntrusive<Multiplicity>, intrusive_policy,
+    std::conditional_t<IsSlot<Multiplicity>, slot_policy,
+                       concurrent_policy>>>;
 
 } // namespace
 
 template <template <class Y, class M> class StdSmart, class Y, class M>
 inline void utilize(StdSmart<Y, M>&& other) noexcept
-{ StdSmart<Y, tag::optional>{std::move(other)}; }
+{ StdSmart<Y, Optional<M>>{std::move(other)}; }
 
 template <class T, class Multiplicity>
 class base
@@ -85,11 +134,31 @@ protected:
 
     static constexpr bool IsOptional = internal::IsOptional<Multiplicity>;
     static constexpr bool IsSingle   = internal::IsSingle<Multiplicity>;
+    static constexpr bool IsChecked  = IsSingle && CheckedSingle;
+
+    // Whether a pointer made from a pointer of the multiplicity M
+    // is certainly not null if it must not be.
+    template <class M>
+    static constexpr bool IsTrusted =
+        IsOptional || (internal::IsSingle<M> && !CheckedSingle);
 
 public:
     using element_type = std::remove_extent_t<T>;
 
 protected:
+    // Lets the compiler drop the null checks of an unchecked 'single'.
+    static void assume_not_null(const void* p) noexcept
+    {
+#if defined (__GNUC__)
+        if (p == nullptr)
+            __builtin_unreachable();
+#elif defined (_MSC_VER)
+        __assume(p != nullptr);
+#else
+        (void)p;
+#endif
+    }
+
     UPL_CONCEPT_REQUIRES(IsSingle)
     void handle_empty_single_access() const
     { throw single_error{"'single' is empty"}; }
@@ -97,11 +166,90 @@ protected:
     UPL_CONCEPT_REQUIRES(IsSingle)
     void handle_empty_single_swap() const
     { throw single_error{"'single' can't be swapped with a null pointer"}; }
+
+    // Checks the pointer p of an alias made by an aliasing constructor.
+    static void check_alias(const void* p) noexcept (IsOptional)
+    {
+        static_assert(!IsIntrusive<Multiplicity>,
+                      "an intrusive object can't be aliased, "
+                      "since its counts are found by its pointer");
+
+        if constexpr (IsSingle)
+            if (p == nullptr)
+                throw single_error{"'single' can't alias a null pointer"};
+    }
 };
 
 template <class T, class Multiplicity>
 class weak;
 
+struct caster;
+
+// Selects the constructors that refer to the object of another pointer
+// by an arbitrary pointer p.
+struct aliasing_t
+{
+    explicit aliasing_t() = default;
+};
+
+template <class T, class Multiplicity, bool Bare>
+class strict;
+
+// Only a unique of the referrer with the control block may be bare,
+// see the strong_referrer.
+template <class T, class M>
+std::bool_constant<!IsIntrusive<M> && !IsSlot<M>> is_bare_owner(const strict<T, M, true>*);
+template <class = void>
+std::false_type is_bare_owner(...);
+
+template <class P>
+inline constexpr bool IsBareOwner =
+    decltype(is_bare_owner(std::declval<std::decay_t<P>*>()))::value;
+
+template <class T, class M>
+std::true_type is_based(const base<T, M>*);
+template <class = void>
+std::false_type is_based(...);
+
+// Whether the P is one of the UPL pointers, which are derived from the base.
+template <class P>
+inline constexpr bool IsBased =
+    decltype(is_based(std::declval<std::decay_t<P>*>()))::value;
+
+// Gives a bare unique its control block before the unique gets
+// the second owner or the first observer, is ordered or hashed,
+// or is converted the way that can't keep it bare. The block is allocated here, so the conversions
+// from a unique may throw, while the copies and the moves don't allocate.
+struct attacher
+{
+    template <class P>
+    static P&& share(P&& p)
+    {
+        if constexpr (IsBareOwner<P>)
+            p.m_referrer.attach();
+
+        return std::forward<P>(p);
+    }
+
+    template <class T, class P>
+    static P&& convert(P&& p)
+    {
+        if constexpr (IsBareOwner<P>)
+            p.m_referrer.template attach_converted<T>();
+
+        return std::forward<P>(p);
+    }
+
+    template <class T, class P>
+    static P&& alias(P&& p, const std::remove_extent_t<T>* alias)
+    {
+        if constexpr (IsBareOwner<P>)
+            p.m_referrer.template attach_aliased<T>(alias);
+
+        return std::forward<P>(p);
+    }
+};
+
 template <class T, class Multiplicity>
 class strong : public base<T, Multiplicity>
 {
@@ -116,7 +264,10 @@ protected:
     template <class Y>
     using WeakReferrer = std::weak_ptr<Y>;
 
-    using Referrer = SharedReferrer<T>;
+    template <class Y>
+    using StrongReferrer = strong_referrer<Y, Policy<Multiplicity>>;
+
+    using Referrer = StrongReferrer<T>;
 
 public:
     using typename base<T, multiplicity_type>::element_type;
@@ -135,14 +286,7 @@ public:
     // Move constructors.
     template <class Y, class D, UPL_CONCEPT_REQUIRES_(IsCompatible<T, Y>)>
     strong(UniqueReferrer<Y, D>&& referrer) noexcept (parent::IsOptional)
-        : m_referrer{std::move(referrer)}
-    {
-        // TODO: Optimize.
-        if constexpr (parent::IsSingle)
-            if (!m_referrer)
-                throw single_error{"'single' can't be moved "
-                                   "from a null pointer"};
-    }
+        : strong{std::false_type{}, std::move(referrer)} {}
 
     template <class Y, class D, UPL_CONCEPT_REQUIRES_(IsIncompatible<T, Y>)>
     strong(UniqueReferrer<Y, D>&& referrer) = delete;
@@ -169,30 +313,57 @@ public:
     strong& operator=(UniqueReferrer<Y, D>&& referrer) = delete;
 
     template <class U, class M>
-    bool owner_before(const strong<U, M>& other) const noexcept (parent::IsOptional && strong<U, M>::IsOptional)
+    bool owner_before(const strong<U, M>& other) const noexcept (!parent::IsChecked && !strong<U, M>::IsChecked)
     {
-        // TODO: Should this throw an exception?
-        if constexpr (parent::IsSingle)
+        if constexpr (parent::IsChecked)
             this->check_empty_single_access();
 
         return other.owner_before_inverse(*this);
     }
 
+    // A bare unique gets its block before it is ordered, see the unique.
     template <class U, class M>
-    bool owner_before(const weak<U, M>& other) const noexcept (parent::IsOptional && weak<U, M>::IsOptional)
+    bool owner_before(const strict<U, M, true>& other) const
+        noexcept (!parent::IsChecked && !strong<U, M>::IsChecked && !IsBareOwner<strict<U, M, true>>)
+    { return owner_before(static_cast<const strong<U, M>&>(attacher::share(other))); }
+
+    template <class U, class M>
+    bool owner_before(const weak<U, M>& other) const noexcept (!parent::IsChecked && weak<U, M>::IsOptional)
     {
-        // TODO: Should this throw an exception?
-        if constexpr (parent::IsSingle)
+        if constexpr (parent::IsChecked)
             this->check_empty_single_access();
 
         return other.owner_before_inverse(*this);
     }
 
-    element_type* get() const noexcept (parent::IsOptional)
+    // The equality and the hash of the owners, which are consistent
+    // with the owner_before.
+    template <class U, class M>
+    bool owner_equal(const strong<U, M>& other) const noexcept
+    { return m_referrer.owner_equal(other.m_referrer); }
+
+    template <class U, class M>
+    bool owner_equal(const strict<U, M, true>& other) const noexcept (!IsBareOwner<strict<U, M, true>>)
+    { return owner_equal(static_cast<const strong<U, M>&>(attacher::share(other))); }
+
+    template <class U, class M>
+    bool owner_equal(const weak<U, M>& other) const noexcept
+    { return m_referrer.owner_equal(other.m_referrer); }
+
+    std::size_t owner_hash() const noexcept
+    { return m_referrer.owner_hash(); }
+
+    // The number of the owners, which may be outdated at once
+    // if the object is shared between threads.
+    long use_count() const noexcept
+    { return m_referrer.use_count(); }
+
+    element_type* get() const noexcept (!parent::IsChecked)
     {
-        // TODO: Should this throw an exception?
-        if constexpr (parent::IsSingle)
+        if constexpr (parent::IsChecked)
             this->check_empty_single_access();
+        else if constexpr (parent::IsSingle)
+            this->assume_not_null(m_referrer.get());
 
         return m_referrer.get();
     }
@@ -204,8 +375,26 @@ public:
     explicit constexpr operator bool() const noexcept
     { return true; }
 
-    T& operator*() const noexcept (parent::IsOptional)  { return *get(); }
-    T* operator->() const noexcept (parent::IsOptional) { return get(); }
+    std::add_lvalue_reference_t<T> operator*() const noexcept (!parent::IsChecked)
+    { return *get(); }
+    T* operator->() const noexcept (!parent::IsChecked) { return get(); }
+
+    template <class E = element_type, UPL_CONCEPT_REQUIRES_(std::is_array_v<T>)>
+    E& operator[](std::ptrdiff_t i) const noexcept (!parent::IsChecked)
+    { return get()[i]; }
+
+    // Makes the last owner of the object pass it to the upl::reclaimer
+    // instead of destroying it.
+    void defer_destruction() const noexcept (!parent::IsChecked)
+    {
+        static_assert(std::is_same_v<Policy<Multiplicity>, concurrent_policy>,
+                      "only the shared objects are reclaimed");
+
+        if constexpr (parent::IsChecked)
+            this->check_empty_single_access();
+
+        m_referrer.defer_destruction();
+    }
 
     UPL_CONCEPT_REQUIRES(parent::IsOptional)
     void reset() noexcept { m_referrer.reset(); }
@@ -215,35 +404,48 @@ public:
 
     template <class Y, UPL_CONCEPT_REQUIRES_(IsCompatible<T, Y>)>
     void reset(Y* p)
+    { reset(std::false_type{}, p); }
+
+protected:
+    template <bool Bare, class Y, class ... D>
+    void reset(std::bool_constant<Bare> bare, Y* p, D&& ... d)
     {
-        assert(this->get() == nullptr || this->get() != p);
-        strong{p}.swap_nothrow(*this);
+        assert(m_referrer.get() == nullptr || m_referrer.get() != p);
+        strong{bare, p, std::forward<D>(d) ...}.swap_nothrow(*this);
+    }
+
+    // Creates the referrer of a new object, which is bare, if it is asked
+    // for and the referrer supports it for the arguments.
+    template <bool Bare, class ... Args>
+    static Referrer make_referrer(Args&& ... args)
+    {
+        if constexpr (Bare && std::is_constructible_v<Referrer, bare_t, Args&& ...>)
+            return Referrer{bare_t{}, std::forward<Args>(args) ...};
+        else
+            return Referrer{std::forward<Args>(args) ...};
     }
 
-protected:
     // Value constructors.
     template <class Y>
     explicit strong(Y* p) noexcept (parent::IsOptional)
-        : m_referrer{p}
-    {
-        // TODO: Optimize.
-        if constexpr (parent::IsSingle)
-            if (p == nullptr)
-                throw single_error{"'single' can't be created "
-                                   "from a null pointer."};
-    }
+        : strong{std::false_type{}, p} {}
+
+    // The object is released by the deleter d, if it is passed.
+    template <bool Bare, class Y, class ... D>
+    strong(std::bool_constant<Bare>, Y* p, D&& ... d) noexcept (parent::IsOptional)
+        : m_referrer{make_referrer<Bare>(p, std::forward<D>(d) ...)}
+    { check_not_null("'single' can't be created from a null pointer"); }
+
+    template <bool Bare, class Y, class D>
+    strong(std::bool_constant<Bare>, UniqueReferrer<Y, D>&& referrer) noexcept (parent::IsOptional)
+        : m_referrer{make_referrer<Bare>(std::move(referrer))}
+    { check_not_null("'single' can't be moved from a null pointer"); }
 
     // Copy constructors.
     template <class Y, UPL_CONCEPT_REQUIRES_(IsCompatible<T, Y>)>
     strong(const SharedReferrer<Y>& referrer) noexcept (parent::IsOptional)
         : m_referrer{referrer}
-    {
-        // TODO: Optimize.
-        if constexpr (parent::IsSingle)
-            if (!m_referrer)
-                throw single_error{"'single' can't be copied "
-                                   "from a null pointer"};
-    }
+    { check_not_null("'single' can't be copied from a null pointer"); }
 
     template <class Y, UPL_CONCEPT_REQUIRES_(IsIncompatible<T, Y>)>
     strong(const SharedReferrer<Y>& referrer) = delete;
@@ -261,24 +463,32 @@ protected:
     template <class Y, UPL_CONCEPT_REQUIRES_(IsConstIncorrect<T, Y>)>
     strong(const WeakReferrer<Y>& referrer) = delete;
 
-    strong(const strong& other) noexcept (parent::IsOptional)
-        : strong{other.m_referrer} {}
+    template <class Y>
+    strong(const StrongReferrer<Y>& referrer) noexcept (parent::IsOptional)
+        : m_referrer{referrer}
+    { check_not_null("'single' can't be copied from a null pointer"); }
+
+    // Takes the referrer of a pointer that is not null, if it must not be.
+    template <class Y>
+    strong(std::true_type, const StrongReferrer<Y>& referrer) noexcept
+        : m_referrer{referrer} {}
+
+    template <class Y>
+    strong(std::false_type, const StrongReferrer<Y>& referrer)
+        : strong{referrer} {}
+
+    strong(const strong& other) noexcept (!parent::IsChecked)
+        : strong{std::bool_constant<!parent::IsChecked>{}, other.m_referrer} {}
 
     template <class Y, class M>
-    strong(const strong<Y, M>& other) noexcept (parent::IsOptional)
-        : strong{other.m_referrer} {}
+    strong(const strong<Y, M>& other) noexcept (parent::template IsTrusted<M>)
+        : strong{std::bool_constant<parent::template IsTrusted<M>>{}, other.m_referrer} {}
 
     // Move constructors.
     template <class Y, UPL_CONCEPT_REQUIRES_(IsCompatible<T, Y>)>
     strong(SharedReferrer<Y>&& referrer) noexcept (parent::IsOptional)
         : m_referrer{std::move(referrer)}
-    {
-        // TODO: Optimize.
-        if constexpr (parent::IsSingle)
-            if (!m_referrer)
-                throw single_error{"'single' can't be moved "
-                                   "from a null pointer"};
-    }
+    { check_not_null("'single' can't be moved from a null pointer"); }
 
     template <class Y, UPL_CONCEPT_REQUIRES_(IsIncompatible<T, Y>)>
     strong(SharedReferrer<Y>&& referrer) = delete;
@@ -286,17 +496,45 @@ protected:
     template <class Y, UPL_CONCEPT_REQUIRES_(IsConstIncorrect<T, Y>)>
     strong(SharedReferrer<Y>&& referrer) = delete;
 
-    strong(strong&& other) noexcept (parent::IsOptional)
-        : strong{std::move(other.m_referrer)} {}
+    template <class Y>
+    strong(StrongReferrer<Y>&& referrer) noexcept (parent::IsOptional)
+        : m_referrer{std::move(referrer)}
+    { check_not_null("'single' can't be moved from a null pointer"); }
+
+    template <class Y>
+    strong(std::true_type, StrongReferrer<Y>&& referrer) noexcept
+        : m_referrer{std::move(referrer)} {}
+
+    template <class Y>
+    strong(std::false_type, StrongReferrer<Y>&& referrer)
+        : strong{std::move(referrer)} {}
+
+    strong(strong&& other) noexcept (!parent::IsChecked)
+        : strong{std::bool_constant<!parent::IsChecked>{}, std::move(other.m_referrer)} {}
+
+    template <class Y, class M>
+    strong(strong<Y, M>&& other) noexcept (parent::template IsTrusted<M>)
+        : strong{std::bool_constant<parent::template IsTrusted<M>>{}, std::move(other.m_referrer)} {}
+
+    // Locks the object by the weak reference of the source itself.
+    template <class Y, class M>
+    explicit strong(weak<Y, M>&& other) noexcept (parent::IsOptional)
+        : strong{std::move(other.m_referrer).lock()} {}
+
+    // Refers to the object of the other by the pointer p, which is its
+    // cast pointer or a pointer into it, see the caster.
+    template <class Y, class M>
+    strong(aliasing_t, const strong<Y, M>& other, element_type* p) noexcept
+        : m_referrer{other.m_referrer, p} {}
 
     template <class Y, class M>
-    strong(strong<Y, M>&& other) noexcept (parent::IsOptional)
-        : strong{std::move(other.m_referrer)} {}
+    strong(aliasing_t, strong<Y, M>&& other, element_type* p) noexcept
+        : m_referrer{std::move(other.m_referrer), p} {}
 
     template <class Y, UPL_CONCEPT_REQUIRES_(IsCompatible<T, Y>)>
-    void swap(strong<Y, multiplicity_type>& other) noexcept (parent::IsOptional)
+    void swap(strong<Y, multiplicity_type>& other) noexcept (!parent::IsChecked)
     {
-        if constexpr (parent::IsSingle)
+        if constexpr (parent::IsChecked)
             check_empty_single_swap();
 
         other.swap_inverse(*this);
@@ -313,6 +551,14 @@ protected:
             this->handle_empty_single_access();
     }
 
+    // The sources that are not a 'single' may be null.
+    void check_not_null(const char* message) const
+    {
+        if constexpr (parent::IsSingle)
+            if (!m_referrer)
+                throw single_error{message};
+    }
+
     UPL_CONCEPT_REQUIRES(parent::IsSingle)
     void check_empty_single_swap() const
     {
@@ -320,37 +566,41 @@ protected:
             this->handle_empty_single_swap();
     }
 
-    Referrer copy_referrer() const noexcept
-    { return Referrer{m_referrer}; }
+    // The deleter of the object, which is kept by its control block,
+    // or nullptr.
+    void* deleter() const noexcept
+    { return m_referrer.deleter(); }
+
+    // The std::shared_ptr gets its own control block, so may throw.
+    SharedReferrer<T> copy_referrer() const
+    { return m_referrer.share(); }
 
-    Referrer move_referrer() noexcept
-    { return Referrer{std::move(m_referrer)}; }
+    SharedReferrer<T> move_referrer()
+    { return std::move(m_referrer).share(); }
 
 private:
     template <class U, class M>
-    bool owner_before_inverse(const strong<U, M>& other) const noexcept (parent::IsOptional)
+    bool owner_before_inverse(const strong<U, M>& other) const noexcept (!parent::IsChecked)
     {
-        // TODO: Should this throw an exception?
-        if constexpr (parent::IsSingle)
+        if constexpr (parent::IsChecked)
             this->check_empty_single_access();
 
         return m_referrer.owner_before(other.m_referrer);
     }
 
     template <class U, class M>
-    bool owner_before_inverse(const weak<U, M>& other) const noexcept (parent::IsOptional)
+    bool owner_before_inverse(const weak<U, M>& other) const noexcept (!parent::IsChecked)
     {
-        // TODO: Should this throw an exception?
-        if constexpr (parent::IsSingle)
+        if constexpr (parent::IsChecked)
             this->check_empty_single_access();
 
         return m_referrer.owner_before(other.m_referrer);
     }
 
     template <class Y, UPL_CONCEPT_REQUIRES_(IsCompatible<T, Y>)>
-    void swap_inverse(strong<Y, multiplicity_type>& other) noexcept (parent::IsOptional)
+    void swap_inverse(strong<Y, multiplicity_type>& other) noexcept (!parent::IsChecked)
     {
-        if constexpr (parent::IsSingle)
+        if constexpr (parent::IsChecked)
             check_empty_single_swap();
 
         this->swap_nothrow(other);
@@ -360,16 +610,25 @@ private:
     friend class strong;
     template <class Y, class multiplicity_type>
     friend class weak;
+    friend struct caster;
+    friend struct attacher;
 
     Referrer m_referrer{};
 };
 
-template <class T, class Multiplicity>
+// A Bare strict pointer adopts the objects of the raw pointers and
+// the std::unique_ptr without the control block, see the strong_referrer.
+// The objects created by itself share one allocation with their block.
+template <class T, class Multiplicity, bool Bare = false>
 class strict : public strong<T, Multiplicity>
 {
 protected:
     using parent = strong<T, Multiplicity>;
     using typename parent::multiplicity_type;
+    using typename parent::Referrer;
+
+    template <class Y, class D>
+    using UniqueReferrer = typename parent::template UniqueReferrer<Y, D>;
 
 public:
     // Default constructor.
@@ -380,7 +639,7 @@ public:
         : strict{} {}
 
     template <class Y, UPL_CONCEPT_REQUIRES_(IsCompatible<T, Y>)>
-    explicit strict(Y* p) : parent{p} {}
+    explicit strict(Y* p) : parent{std::bool_constant<Bare>{}, p} {}
 
     template <class Y, UPL_CONCEPT_REQUIRES_(IsIncompatible<T, Y>)>
     strict(Y* p) = delete;
@@ -388,18 +647,29 @@ public:
     template <class Y, UPL_CONCEPT_REQUIRES_(IsConstIncorrect<T, Y>)>
     strict(Y* p) = delete;
 
+    template <class Y, class D, UPL_CONCEPT_REQUIRES_(IsCompatible<T, Y>)>
+    strict(Y* p, D d) : parent{std::bool_constant<Bare>{}, p, std::move(d)} {}
+
+    template <class Y, class D, UPL_CONCEPT_REQUIRES_(IsIncompatible<T, Y>)>
+    strict(Y* p, D d) = delete;
+
+    template <class Y, class D, UPL_CONCEPT_REQUIRES_(IsConstIncorrect<T, Y>)>
+    strict(Y* p, D d) = delete;
+
     // Itself constructors.
-    template <class ... Args, UPL_CONCEPT_REQUIRES_(!std::is_abstract_v<T>)>
+    template <class ... Args, class Y = T, UPL_CONCEPT_REQUIRES_(!std::is_abstract_v<Y>)>
     explicit strict(itself_t, Args&& ... args)
-        : parent{std::make_shared<T>(std::forward<Args>(args) ...)} {}
+        : parent{std::true_type{},
+                 Referrer{itself_type_t<T>{}, std::forward<Args>(args) ...}} {}
 
-    template <class ... Args, UPL_CONCEPT_REQUIRES_(std::is_abstract_v<T>)>
+    template <class ... Args, class Y = T, UPL_CONCEPT_REQUIRES_(std::is_abstract_v<Y>)>
     strict(itself_t, Args&& ... args) = delete;
 
     template <class Y, class ... Args, UPL_CONCEPT_REQUIRES_(  IsCompatible<T, Y>
                                                             && !std::is_abstract_v<Y>)>
-    explicit strict(itself_type_t<Y>, Args&& ... args)
-        : parent{std::make_shared<Y>(std::forward<Args>(args) ...)} {}
+    explicit strict(itself_type_t<Y> itself, Args&& ... args)
+        : parent{std::true_type{},
+                 Referrer{itself, std::forward<Args>(args) ...}} {}
 
     template <class Y, class ... Args, UPL_CONCEPT_REQUIRES_(IsIncompatible<T, Y>)>
     strict(itself_type_t<Y>, Args&& ... args) = delete;
@@ -410,9 +680,83 @@ public:
     template <class Y, class ... Args, UPL_CONCEPT_REQUIRES_(std::is_abstract_v<Y>)>
     strict(itself_type_t<Y>, Args&& ... args) = delete;
 
+    template <class ... Args, class Y = T, UPL_CONCEPT_REQUIRES_(!std::is_abstract_v<Y>)>
+    explicit strict(itself_isolated_t isolated, Args&& ... args)
+        : parent{std::true_type{},
+                 Referrer{isolated, itself_type_t<T>{}, std::forward<Args>(args) ...}} {}
+
+    template <class ... Args, class Y = T, UPL_CONCEPT_REQUIRES_(std::is_abstract_v<Y>)>
+    strict(itself_isolated_t, Args&& ... args) = delete;
+
+    // Allocator itself constructors.
+    template <class Alloc, class ... Args, class Y = T, UPL_CONCEPT_REQUIRES_(!std::is_abstract_v<Y>)>
+    explicit strict(std::allocator_arg_t, const Alloc& alloc, itself_t, Args&& ... args)
+        : parent{std::true_type{},
+                 Referrer{std::allocator_arg, alloc,
+                          itself_type_t<T>{}, std::forward<Args>(args) ...}} {}
+
+    template <class Alloc, class ... Args, class Y = T, UPL_CONCEPT_REQUIRES_(std::is_abstract_v<Y>)>
+    strict(std::allocator_arg_t, const Alloc& alloc, itself_t, Args&& ... args) = delete;
+
+    template <class Alloc, class ... Args, class Y = T, UPL_CONCEPT_REQUIRES_(!std::is_abstract_v<Y>)>
+    explicit strict(std::allocator_arg_t, const Alloc& alloc,
+                    itself_isolated_t isolated, Args&& ... args)
+        : parent{std::true_type{},
+                 Referrer{std::allocator_arg, alloc,
+                          isolated, itself_type_t<T>{}, std::forward<Args>(args) ...}} {}
+
+    template <class Alloc, class ... Args, class Y = T, UPL_CONCEPT_REQUIRES_(std::is_abstract_v<Y>)>
+    strict(std::allocator_arg_t, const Alloc& alloc, itself_isolated_t, Args&& ... args) = delete;
+
+    template <class Alloc, class Y, class ... Args,
+              UPL_CONCEPT_REQUIRES_(  IsCompatible<T, Y>
+                                   && !std::is_abstract_v<Y>)>
+    explicit strict(std::allocator_arg_t, const Alloc& alloc,
+                    itself_type_t<Y> itself, Args&& ... args)
+        : parent{std::true_type{},
+                 Referrer{std::allocator_arg, alloc,
+                          itself, std::forward<Args>(args) ...}} {}
+
+    template <class Alloc, class Y, class ... Args, UPL_CONCEPT_REQUIRES_(IsIncompatible<T, Y>)>
+    strict(std::allocator_arg_t, const Alloc& alloc,
+           itself_type_t<Y>, Args&& ... args) = delete;
+
+    template <class Alloc, class Y, class ... Args, UPL_CONCEPT_REQUIRES_(IsConstIncorrect<T, Y>)>
+    strict(std::allocator_arg_t, const Alloc& alloc,
+           itself_type_t<Y>, Args&& ... args) = delete;
+
+    template <class Alloc, class Y, class ... Args, UPL_CONCEPT_REQUIRES_(std::is_abstract_v<Y>)>
+    strict(std::allocator_arg_t, const Alloc& alloc,
+           itself_type_t<Y>, Args&& ... args) = delete;
+
+    // Move constructors.
+    template <class Y, class D, UPL_CONCEPT_REQUIRES_(IsCompatible<T, Y>)>
+    strict(UniqueReferrer<Y, D>&& referrer) noexcept (parent::IsOptional)
+        : parent{std::bool_constant<Bare>{}, std::move(referrer)} {}
+
+    UPL_CONCEPT_REQUIRES(parent::IsOptional)
+    void reset() noexcept { parent::reset(); }
+
+    UPL_CONCEPT_REQUIRES(parent::IsSingle)
+    void reset() = delete;
+
+    template <class Y, UPL_CONCEPT_REQUIRES_(IsCompatible<T, Y>)>
+    void reset(Y* p)
+    { parent::reset(std::bool_constant<Bare>{}, p); }
+
+    template <class Y, class D, UPL_CONCEPT_REQUIRES_(IsCompatible<T, Y>)>
+    void reset(Y* p, D d)
+    { parent::reset(std::bool_constant<Bare>{}, p, std::move(d)); }
+
 protected:
     using parent::strong;
     using parent::operator=;
+
+    // Takes the object of a strict pointer that creates its objects
+    // the other way.
+    template <class Y, class M, bool B>
+    strict(strict<Y, M, B>&& other) noexcept (parent::template IsTrusted<M>)
+        : parent{static_cast<strong<Y, M>&&>(other)} {}
 };
 
 template <class T, class Multiplicity>
@@ -429,9 +773,14 @@ protected:
     template <class Y>
     using WeakReferrer = std::weak_ptr<Y>;
 
-    using Referrer = WeakReferrer<T>;
+    template <class Y>
+    using StrongReferrer = strong_referrer<Y, Policy<Multiplicity>>;
+
+    using Referrer = weak_referrer<T, Policy<Multiplicity>>;
 
 public:
+    using typename parent::element_type;
+
     // Default constructors.
     UPL_CONCEPT_REQUIRES(parent::IsOptional)
     constexpr weak() noexcept {}
@@ -469,9 +818,44 @@ public:
     bool owner_before(const strong<U, M>& other) const noexcept (parent::IsOptional && strong<U, M>::IsOptional)
     { return other.owner_before_inverse(*this); }
 
+    // A bare unique gets its block before it is ordered, see the unique.
+    template <class U, class M>
+    bool owner_before(const strict<U, M, true>& other) const
+        noexcept (parent::IsOptional && strong<U, M>::IsOptional && !IsBareOwner<strict<U, M, true>>)
+    { return owner_before(static_cast<const strong<U, M>&>(attacher::share(other))); }
+
+    // The equality and the hash of the owners, which are consistent
+    // with the owner_before. They stay the same after the object expires.
+    template <class U, class M>
+    bool owner_equal(const weak<U, M>& other) const noexcept
+    { return m_referrer.owner_equal(other.m_referrer); }
+
+    template <class U, class M>
+    bool owner_equal(const strong<U, M>& other) const noexcept
+    { return m_referrer.owner_equal(other.m_referrer); }
+
+    template <class U, class M>
+    bool owner_equal(const strict<U, M, true>& other) const noexcept (!IsBareOwner<strict<U, M, true>>)
+    { return owner_equal(static_cast<const strong<U, M>&>(attacher::share(other))); }
+
+    std::size_t owner_hash() const noexcept
+    { return m_referrer.owner_hash(); }
+
+    // The number of the owners, which may be outdated at once
+    // if the object is shared between threads.
+    long use_count() const noexcept
+    { return m_referrer.use_count(); }
+
     bool expired() const noexcept
     { return m_referrer.expired(); }
 
+    // Calls the success_action for the alive object without changing
+    // its counts, otherwise calls the failure_action.
+    template <class SuccessAction, class FailureAction>
+    auto visit(SuccessAction success_action,
+               FailureAction failure_action) const
+    { return m_referrer.visit(success_action, failure_action); }
+
     UPL_CONCEPT_REQUIRES(parent::IsOptional)
     void reset() noexcept { m_referrer.reset(); }
 
@@ -500,6 +884,14 @@ protected:
     template <class Y, UPL_CONCEPT_REQUIRES_(IsConstIncorrect<T, Y>)>
     weak(const SharedReferrer<Y>& referrer) = delete;
 
+    template <class Y>
+    weak(const weak_referrer<Y, Policy<Multiplicity>>& referrer) noexcept
+        : m_referrer{referrer} {}
+
+    template <class Y>
+    weak(const StrongReferrer<Y>& referrer) noexcept
+        : m_referrer{referrer} {}
+
     weak(const weak& other) noexcept
         : weak{other.m_referrer} {}
 
@@ -522,6 +914,10 @@ protected:
     template <class Y, UPL_CONCEPT_REQUIRES_(IsConstIncorrect<T, Y>)>
     weak(WeakReferrer<Y>&& referrer) = delete;
 
+    template <class Y>
+    weak(weak_referrer<Y, Policy<Multiplicity>>&& referrer) noexcept
+        : m_referrer{std::move(referrer)} {}
+
     weak(weak&& other) noexcept
         : weak{std::move(other.m_referrer)} {}
 
@@ -529,11 +925,24 @@ protected:
     weak(weak<Y, M>&& other) noexcept
         : weak{std::move(other.m_referrer)} {}
 
+    // Refers to the block of the other by the pointer p into its object.
+    template <class Y, class M>
+    weak(aliasing_t, const weak<Y, M>& other, element_type* p) noexcept
+        : m_referrer{other.m_referrer, p} {}
+
+    template <class Y, class M>
+    weak(aliasing_t, weak<Y, M>&& other, element_type* p) noexcept
+        : m_referrer{std::move(other.m_referrer), p} {}
+
+    template <class Y, class M>
+    weak(aliasing_t, const strong<Y, M>& other, element_type* p) noexcept
+        : m_referrer{other.m_referrer, p} {}
+
     template <class Y, UPL_CONCEPT_REQUIRES_(IsCompatible<T, Y>)>
     void swap(weak<Y, multiplicity_type>& other) noexcept
     { m_referrer.swap(other.m_referrer); }
 
-    SharedReferrer<T> lock() const noexcept { return m_referrer.lock(); }
+    StrongReferrer<T> lock() const noexcept { return m_referrer.lock(); }
 
 private:
     template <class U, class M>
@@ -544,10 +953,23 @@ private:
     bool owner_before_inverse(const strong<U, M>& other) const noexcept (parent::IsOptional)
     { return m_referrer.owner_before(other.m_referrer); }
 
+    // Whether the other stores the same pointer, which may be aliased.
+    // An intrusive pointer is obtained from its owner, so it is the same.
+    template <class U, class M>
+    bool stores_same(const weak<U, M>& other) const noexcept
+    {
+        if constexpr (IsIntrusive<multiplicity_type>)
+            return true;
+        else
+            return m_referrer.get() == other.m_referrer.get();
+    }
+
     template <class Y, class multiplicity_type>
     friend class strong;
     template <class Y, class multiplicity_type>
     friend class weak;
+    template <template <class Y, class M> class Pointer, class Y, class M>
+    friend class atomic_pointer;
 
     Referrer m_referrer;
 };
@@ -558,6 +980,8 @@ template <class T, class Multiplicity>
 class unified;
 template <class T, class Multiplicity>
 class unique;
+template <class T, class Multiplicity, class Deleter>
+class custom_unique;
 template <class T, class Multiplicity>
 class shared;
 template <class T, class Multiplicity>
@@ -589,13 +1013,18 @@ public:
     using parent::operator=;
 
     // Copy constructors.
-    unified(const unified& other) noexcept (parent::IsOptional)
+    unified(const unified& other) noexcept (!parent::IsChecked)
         : parent{other} {}
 
     template <class Y, class M, UPL_CONCEPT_REQUIRES_(IsCompatible<Y>)>
-    unified(const internal::strong<Y, M>& other) noexcept (parent::IsOptional)
+    unified(const internal::strong<Y, M>& other) noexcept (parent::template IsTrusted<M>)
         : parent{other} {}
 
+    // A unique gets its control block, so the copy may throw.
+    template <class Y, class M, UPL_CONCEPT_REQUIRES_(IsCompatible<Y>)>
+    unified(const unique<Y, M>& other)
+        : parent{internal::attacher::share(other)} {}
+
     template <class Y, class M, UPL_CONCEPT_REQUIRES_(IsCompatible<Y>)>
     unified(const weak<Y, M>& other) noexcept (parent::IsOptional)
         : unified{other.lock()} {}
@@ -620,22 +1049,22 @@ public:
     unified(unified&& other) = default;
 
     template <class Y, class M, UPL_CONCEPT_REQUIRES_(IsCompatible<Y>)>
-    unified(unified<Y, M>&& other) noexcept (parent::IsOptional)
+    unified(unified<Y, M>&& other) noexcept (parent::template IsTrusted<M>)
         : parent{std::move(other)} {}
 
     template <template <class Y, class M> class StdSmart, class Y, class M,
               UPL_CONCEPT_REQUIRES_(  IsCompatible<Y>
                                    && (  std::is_base_of_v<unique<Y, M>, StdSmart<Y, M>>
                                       || std::is_base_of_v<shared<Y, M>, StdSmart<Y, M>>))>
-    unified(StdSmart<Y, M>&& other) noexcept (parent::IsOptional)
-        : parent{std::move(other)} {}
+    unified(StdSmart<Y, M>&& other) noexcept (   parent::IsOptional
+                                             && !internal::IsBareOwner<StdSmart<Y, M>>)
+        : parent{internal::attacher::share(std::move(other))} {}
 
     template <template <class Y, class M> class StdSmart, class Y, class M,
               UPL_CONCEPT_REQUIRES_(  IsCompatible<Y>
                                    && std::is_base_of_v<weak<Y, M>, StdSmart<Y, M>>)>
-    unified(StdSmart<Y, M>&& other)
-        : unified{other.lock()}
-    { internal::utilize(std::move(other)); }
+    unified(StdSmart<Y, M>&& other) noexcept (parent::IsOptional)
+        : parent{static_cast<internal::weak<Y, M>&&>(other)} {}
 
     template <class Y>
     unified(SharedReferrer<Y>&& referrer) noexcept (parent::IsOptional)
@@ -654,6 +1083,30 @@ public:
               UPL_CONCEPT_REQUIRES_(IsConstIncorrect<Y>)>
     unified(StdSmart<Y, M>&& other) = delete;
 
+    // Aliasing constructors: the result refers to the object of the other
+    // by the pointer p, e.g. to its member or element, and keeps it alive.
+    template <class Y, class M>
+    unified(const internal::strong<Y, M>& other,
+            typename parent::element_type* p) noexcept (parent::IsOptional)
+        : parent{internal::aliasing_t{}, other, p}
+    { parent::check_alias(p); }
+
+    template <class Y, class M>
+    unified(internal::strong<Y, M>&& other,
+            typename parent::element_type* p) noexcept (parent::IsOptional)
+        : parent{internal::aliasing_t{}, std::move(other), p}
+    { parent::check_alias(p); }
+
+    template <class Y, class M>
+    unified(const unique<Y, M>& other, typename parent::element_type* p)
+        : parent{internal::aliasing_t{}, internal::attacher::share(other), p}
+    { parent::check_alias(p); }
+
+    template <class Y, class M>
+    unified(unique<Y, M>&& other, typename parent::element_type* p)
+        : parent{internal::aliasing_t{}, internal::attacher::share(std::move(other)), p}
+    { parent::check_alias(p); }
+
     // Copy operators.
     unified& operator=(const unified& other) noexcept
     {
@@ -665,7 +1118,8 @@ public:
               UPL_CONCEPT_REQUIRES_(  IsCompatible<Y>
                                    && std::is_base_of_v<internal::strong<Y, M>,
                                                         StdSmart<Y, M>>)>
-    unified& operator=(const StdSmart<Y, M>& other) noexcept (parent::IsOptional)
+    unified& operator=(const StdSmart<Y, M>& other) noexcept (   parent::IsOptional
+                                                             && !internal::IsBareOwner<StdSmart<Y, M>>)
     {
         unified{other}.swap_nothrow(*this);
         return *this;
@@ -720,18 +1174,10 @@ public:
               UPL_CONCEPT_REQUIRES_(  IsCompatible<Y>
                                    && std::is_base_of_v<internal::strong<Y, M>,
                                                         StdSmart<Y, M>>)>
-    unified& operator=(StdSmart<Y, M>&& other) noexcept (parent::IsOptional)
+    unified& operator=(StdSmart<Y, M>&& other) noexcept (   parent::IsOptional
+                                                        && !internal::IsBareOwner<StdSmart<Y, M>>)
     {
-        if constexpr (std::is_base_of_v<unified<Y, M>, StdSmart<Y, M>>)
-        {
-            unified{std::move(other)}.swap_nothrow(*this);
-        }
-        else
-        {
-            unified{other}.swap_nothrow(*this);
-            internal::utilize(std::move(other));
-        }
-
+        unified{std::move(other)}.swap_nothrow(*this);
         return *this;
     }
 
@@ -739,10 +1185,9 @@ public:
               UPL_CONCEPT_REQUIRES_(  IsCompatible<Y>
                                    && std::is_base_of_v<weak<Y, M>,
                                                         StdSmart<Y, M>>)>
-    unified& operator=(StdSmart<Y, M>&& other)
+    unified& operator=(StdSmart<Y, M>&& other) noexcept (parent::IsOptional)
     {
-        unified{other}.swap_nothrow(*this);
-        internal::utilize(std::move(other));
+        unified{std::move(other)}.swap_nothrow(*this);
         return *this;
     }
 
@@ -768,15 +1213,23 @@ public:
               UPL_CONCEPT_REQUIRES_(IsConstIncorrect<Y>)>
     unified& operator=(StdSmart<Y, M>&& other) = delete;
 
-    void     swap(unified& other) noexcept (parent::IsOptional)
+    void     swap(unified& other) noexcept (!parent::IsChecked)
     { parent::swap(other); }
+
+private:
+    template <class Y>
+    unified(internal::strong_referrer<Y, internal::Policy<Multiplicity>>&& referrer) noexcept (parent::IsOptional)
+        : parent{std::move(referrer)} {}
+
+    template <class Y, class M>
+    friend class weak;
 };
 
 template <class T, class Multiplicity>
-class unique : public internal::strict<T, Multiplicity>
+class unique : public internal::strict<T, Multiplicity, true>
 {
 private:
-    using parent = internal::strict<T, Multiplicity>;
+    using parent = internal::strict<T, Multiplicity, true>;
     using typename parent::multiplicity_type;
 
     template <class Y>
@@ -829,9 +1282,13 @@ public:
     // Move constructors.
     unique(unique&& other) = default;
 
+    // A bare object gets its control block, if the unique of the T
+    // can't delete it, so only the moves of the same type don't throw.
     template <class Y, class M, UPL_CONCEPT_REQUIRES_(IsCompatible<Y>)>
-    unique(unique<Y, M>&& other) noexcept (parent::IsOptional)
-        : parent{std::move(other)} {}
+    unique(unique<Y, M>&& other) noexcept (   parent::template IsTrusted<M>
+                                          && std::is_same_v<std::remove_cv_t<Y>,
+                                                            std::remove_cv_t<T>>)
+        : parent{internal::attacher::convert<T>(std::move(other))} {}
 
     template <class Y, class M>
     unique(unified<Y, M>&& other) = delete;
@@ -926,8 +1383,241 @@ public:
               UPL_CONCEPT_REQUIRES_(IsConstIncorrect<Y>)>
     unique& operator=(StdSmart<Y, M>&& other) = delete;
 
-    void    swap(unique& other) noexcept (parent::IsOptional)
+    // A bare object gets its control block, so it may throw.
+    void defer_destruction() const
+    {
+        internal::attacher::share(*this);
+        parent::defer_destruction();
+    }
+
+    // A bare object gets its control block before it is ordered or hashed,
+    // so its key does not change when it is observed later.
+    template <class P>
+    auto owner_before(const P& other) const
+        noexcept (   !internal::IsBareOwner<unique>
+                  && noexcept(std::declval<const parent&>().owner_before(other)))
+        -> decltype(std::declval<const parent&>().owner_before(other))
+    {
+        internal::attacher::share(*this);
+        return parent::owner_before(other);
+    }
+
+    template <class P>
+    auto owner_equal(const P& other) const
+        noexcept (   !internal::IsBareOwner<unique>
+                  && noexcept(std::declval<const parent&>().owner_equal(other)))
+        -> decltype(std::declval<const parent&>().owner_equal(other))
+    {
+        internal::attacher::share(*this);
+        return parent::owner_equal(other);
+    }
+
+    std::size_t owner_hash() const noexcept (!internal::IsBareOwner<unique>)
+    {
+        internal::attacher::share(*this);
+        return parent::owner_hash();
+    }
+
+    void    swap(unique& other) noexcept (!parent::IsChecked)
     { parent::swap(other); }
+
+private:
+    template <class Y, class M, class D>
+    friend class custom_unique;
+};
+
+// A unique pointer that takes the objects with the Deleter.
+// The deleter is kept by the owner of an object: a deleter with a state
+// by the control block, and a stateless one, which takes no space and
+// no control block, by the description of a bare object, see
+// the strong_referrer. The pointer keeps its unique to itself, so it takes
+// only the objects of the same Deleter, and the objects of
+// a std::unique_ptr, whose deleter is converted to the Deleter. It is
+// converted to the other pointers as its unique is.
+template <class T, class Multiplicity, class Deleter>
+class custom_unique
+{
+    static_assert(!internal::IsSlot<Multiplicity>,
+                  "a slot object is released by its arena");
+
+private:
+    using Unique = unique<T, Multiplicity>;
+
+    static constexpr bool IsOptional = Unique::IsOptional;
+    static constexpr bool IsSingle   = Unique::IsSingle;
+    static constexpr bool IsChecked  = Unique::IsChecked;
+
+    template <class Y>
+    static constexpr bool IsCompatible = internal::IsCompatible<T, Y>;
+
+    template <class Y>
+    static constexpr bool IsIncompatible = internal::IsIncompatible<T, Y>;
+
+    template <class Y>
+    static constexpr bool IsConstIncorrect = internal::IsConstIncorrect<T, Y>;
+
+    // The UPL pointers, which are made from the unique of the pointer.
+    template <class P, class U>
+    static constexpr bool IsConversion =
+        internal::IsBased<P> && std::is_constructible_v<P, U>;
+
+public:
+    using element_type = typename Unique::element_type;
+    using deleter_type = Deleter;
+
+    // Default constructors.
+    UPL_CONCEPT_REQUIRES(IsOptional)
+    constexpr custom_unique() noexcept : m_unique{} {}
+
+    UPL_CONCEPT_REQUIRES(IsSingle)
+    custom_unique() = delete;
+
+    UPL_CONCEPT_REQUIRES(IsOptional)
+    constexpr custom_unique(std::nullptr_t) noexcept : m_unique{} {}
+
+    // Value constructors.
+    template <class Y, UPL_CONCEPT_REQUIRES_(IsCompatible<Y>)>
+    explicit custom_unique(Y* p)
+        : m_unique{p, Deleter{}} {}
+
+    template <class Y, UPL_CONCEPT_REQUIRES_(IsCompatible<Y>)>
+    custom_unique(Y* p, Deleter d)
+        : m_unique{p, std::move(d)} {}
+
+    template <class Y, UPL_CONCEPT_REQUIRES_(IsIncompatible<Y>)>
+    custom_unique(Y* p) = delete;
+
+    template <class Y, UPL_CONCEPT_REQUIRES_(IsConstIncorrect<Y>)>
+    custom_unique(Y* p) = delete;
+
+    // Move constructors.
+    custom_unique(custom_unique&& other) = default;
+
+    template <class Y, class M, UPL_CONCEPT_REQUIRES_(IsCompatible<Y>)>
+    custom_unique(custom_unique<Y, M, Deleter>&& other)
+        noexcept (std::is_nothrow_constructible_v<Unique, unique<Y, M>&&>)
+        : m_unique{std::move(other.m_unique)} {}
+
+    // The object of a unique is deleted by its own deleter.
+    template <class Y, class M>
+    custom_unique(unique<Y, M>&& other) = delete;
+
+    // The deleter is converted before the object is taken, so the object
+    // stays with the source if the conversion throws.
+    template <class Y, class D,
+              UPL_CONCEPT_REQUIRES_(   IsCompatible<Y>
+                                    && std::is_convertible_v<D, Deleter>
+                                    && std::is_same_v<typename std::unique_ptr<Y, D>::pointer, Y*>)>
+    custom_unique(std::unique_ptr<Y, D>&& other)
+        : custom_unique{std::move(other), Deleter(std::forward<D>(other.get_deleter()))} {}
+
+    // Move operators.
+    custom_unique& operator=(custom_unique&& other) = default;
+
+    template <class Y, class M, UPL_CONCEPT_REQUIRES_(IsCompatible<Y>)>
+    custom_unique& operator=(custom_unique<Y, M, Deleter>&& other)
+    {
+        m_unique = std::move(other.m_unique);
+        return *this;
+    }
+
+    template <class Y, class M>
+    custom_unique& operator=(unique<Y, M>&& other) = delete;
+
+    UPL_CONCEPT_REQUIRES(IsOptional)
+    custom_unique& operator=(std::nullptr_t) noexcept
+    {
+        m_unique = nullptr;
+        return *this;
+    }
+
+    // The unique is moved to the other strong pointers, and a weak one
+    // observes it, so only a custom_unique keeps the Deleter of its type.
+    template <class P, UPL_CONCEPT_REQUIRES_(IsConversion<P, Unique&&>)>
+    operator P() &&
+    { return P{std::move(m_unique)}; }
+
+    template <class P, UPL_CONCEPT_REQUIRES_(IsConversion<P, const Unique&>)>
+    operator P() const &
+    { return P{m_unique}; }
+
+    template <class P>
+    auto owner_before(const P& other) const
+        noexcept (noexcept(std::declval<const Unique&>().owner_before(other)))
+        -> decltype(std::declval<const Unique&>().owner_before(other))
+    { return m_unique.owner_before(other); }
+
+    template <class Y, class M, class D>
+    bool owner_before(const custom_unique<Y, M, D>& other) const
+        noexcept (noexcept(std::declval<const Unique&>().owner_before(other.m_unique)))
+    { return m_unique.owner_before(other.m_unique); }
+
+    template <class P>
+    auto owner_equal(const P& other) const
+        noexcept (noexcept(std::declval<const Unique&>().owner_equal(other)))
+        -> decltype(std::declval<const Unique&>().owner_equal(other))
+    { return m_unique.owner_equal(other); }
+
+    template <class Y, class M, class D>
+    bool owner_equal(const custom_unique<Y, M, D>& other) const
+        noexcept (noexcept(std::declval<const Unique&>().owner_equal(other.m_unique)))
+    { return m_unique.owner_equal(other.m_unique); }
+
+    std::size_t owner_hash() const noexcept (noexcept(std::declval<const Unique&>().owner_hash()))
+    { return m_unique.owner_hash(); }
+
+    long use_count() const noexcept
+    { return m_unique.use_count(); }
+
+    element_type* get() const noexcept (!IsChecked)
+    { return m_unique.get(); }
+
+    explicit operator bool() const noexcept
+    { return static_cast<bool>(m_unique); }
+
+    std::add_lvalue_reference_t<T> operator*() const noexcept (!IsChecked)
+    { return *m_unique; }
+    T* operator->() const noexcept (!IsChecked) { return m_unique.get(); }
+
+    template <class E = element_type, UPL_CONCEPT_REQUIRES_(std::is_array_v<T>)>
+    E& operator[](std::ptrdiff_t i) const noexcept (!IsChecked)
+    { return m_unique[i]; }
+
+    void defer_destruction() const
+    { m_unique.defer_destruction(); }
+
+    UPL_CONCEPT_REQUIRES(IsOptional)
+    void reset() noexcept { m_unique.reset(); }
+
+    UPL_CONCEPT_REQUIRES(IsSingle)
+    void reset() = delete;
+
+    template <class Y, UPL_CONCEPT_REQUIRES_(IsCompatible<Y>)>
+    void reset(Y* p)
+    { m_unique.reset(p, Deleter{}); }
+
+    template <class Y, UPL_CONCEPT_REQUIRES_(IsCompatible<Y>)>
+    void reset(Y* p, Deleter d)
+    { m_unique.reset(p, std::move(d)); }
+
+    // Returns the deleter of the object, which is kept by its control
+    // block or by the description of its object, or nullptr for
+    // an empty pointer.
+    Deleter* get_deleter() const noexcept
+    { return static_cast<Deleter*>(m_unique.deleter()); }
+
+    void swap(custom_unique& other) noexcept (!IsChecked)
+    { m_unique.swap(other.m_unique); }
+
+private:
+    template <class Y, class D>
+    custom_unique(std::unique_ptr<Y, D>&& other, Deleter d)
+        : m_unique{other.release(), std::move(d)} {}
+
+    template <class Y, class M, class D>
+    friend class custom_unique;
+
+    Unique m_unique;
 };
 
 template <class T, class Multiplicity>
@@ -950,18 +1640,17 @@ private:
     using SharedReferrer = typename parent::template SharedReferrer<Y>;
     template <class Y>
     using WeakReferrer = typename parent::template WeakReferrer<Y>;
-    using Referrer     = typename parent::Referrer;
 
 public:
     using parent::strict;
     using parent::operator=;
 
     // Copy constructors.
-    shared(const shared& other) noexcept (parent::IsOptional)
+    shared(const shared& other) noexcept (!parent::IsChecked)
         : parent{other} {}
 
     template <class Y, class M, UPL_CONCEPT_REQUIRES_(IsCompatible<Y>)>
-    shared(const shared<Y, M>& other) noexcept (parent::IsOptional)
+    shared(const shared<Y, M>& other) noexcept (parent::template IsTrusted<M>)
         : parent{other} {}
 
     template <class Y, class M>
@@ -993,15 +1682,16 @@ public:
     shared(shared&& other) = default;
 
     template <class Y, class M, UPL_CONCEPT_REQUIRES_(IsCompatible<Y>)>
-    shared(shared<Y, M>&& other) noexcept (parent::IsOptional)
+    shared(shared<Y, M>&& other) noexcept (parent::template IsTrusted<M>)
         : parent{std::move(other)} {}
 
     template <class Y, class M>
     shared(unified<Y, M>&& other) = delete;
 
+    // A unique gets its control block, so the move may throw.
     template <class Y, class M, UPL_CONCEPT_REQUIRES_(IsCompatible<Y>)>
-    shared(unique<Y, M>&& other) noexcept (parent::IsOptional)
-        : parent{std::move(other)} {}
+    shared(unique<Y, M>&& other)
+        : parent{internal::attacher::share(std::move(other))} {}
 
     template <class Y, class M>
     shared(weak<Y, M>&& other) = delete;
@@ -1023,15 +1713,34 @@ public:
               UPL_CONCEPT_REQUIRES_(IsConstIncorrect<Y>)>
     shared(StdSmart<Y, M>&& other) = delete;
 
+    // Aliasing constructors: the result refers to the object of the other
+    // by the pointer p, e.g. to its member or element, and keeps it alive.
+    template <class Y, class M>
+    shared(const shared<Y, M>& other,
+           typename parent::element_type* p) noexcept (parent::IsOptional)
+        : parent{internal::aliasing_t{}, other, p}
+    { parent::check_alias(p); }
+
+    template <class Y, class M>
+    shared(shared<Y, M>&& other,
+           typename parent::element_type* p) noexcept (parent::IsOptional)
+        : parent{internal::aliasing_t{}, std::move(other), p}
+    { parent::check_alias(p); }
+
+    template <class Y, class M>
+    shared(unique<Y, M>&& other, typename parent::element_type* p)
+        : parent{internal::aliasing_t{}, internal::attacher::share(std::move(other)), p}
+    { parent::check_alias(p); }
+
     // Copy operators.
-    shared& operator=(const shared& other) noexcept (parent::IsOptional)
+    shared& operator=(const shared& other) noexcept (!parent::IsChecked)
     {
         return this->template operator=<T, multiplicity_type>(
             static_cast<const shared<T, multiplicity_type>&>(other));
     }
 
     template <class Y, class M, UPL_CONCEPT_REQUIRES_(IsCompatible<Y>)>
-    shared& operator=(const shared<Y, M>& other) noexcept (parent::IsOptional)
+    shared& operator=(const shared<Y, M>& other) noexcept (parent::template IsTrusted<M>)
     {
         shared{other}.swap_nothrow(*this);
         return *this;
@@ -1110,28 +1819,30 @@ public:
               UPL_CONCEPT_REQUIRES_(IsConstIncorrect<Y>)>
     shared& operator=(StdSmart<Y, M>&& other) = delete;
 
-    operator Referrer() const & noexcept
+    operator SharedReferrer<T>() const &
     { return this->copy_referrer(); }
 
-    operator Referrer() && noexcept
+    operator SharedReferrer<T>() &&
     { return this->move_referrer(); }
 
     template <class Y>
-    operator SharedReferrer<Y>() const & noexcept
+    operator SharedReferrer<Y>() const &
     { return std::static_pointer_cast<Y>(this->copy_referrer()); }
 
     template <class Y>
-    operator SharedReferrer<Y>() && noexcept
+    operator SharedReferrer<Y>() &&
     { return SharedReferrer<Y>{this->move_referrer()}; }
 
+    // The std::weak_ptr can't observe the UPL control block: it would
+    // observe a temporary std::shared_ptr, which expires at once.
+    // See the migration note in the reference.
     template <class Y>
-    operator WeakReferrer<Y>() const & noexcept
-    { return WeakReferrer<Y>{this->copy_referrer()}; }
+    operator WeakReferrer<Y>() const & = delete;
 
     template <class Y>
     operator WeakReferrer<Y>() && = delete;
 
-    void swap(shared& other) noexcept (parent::IsOptional)
+    void swap(shared& other) noexcept (!parent::IsChecked)
     { parent::swap(other); }
 };
 
@@ -1172,6 +1883,11 @@ public:
     weak(const internal::strong<Y, M>& other) noexcept
         : parent{other} {}
 
+    // A unique gets its control block, so the observing may throw.
+    template <class Y, class M, UPL_CONCEPT_REQUIRES_(IsCompatible<Y>)>
+    weak(const unique<Y, M>& other)
+        : parent{internal::attacher::share(other)} {}
+
     template <class Y>
     weak(const SharedReferrer<Y>& referrer) noexcept (parent::IsOptional)
         : parent{referrer} {}
@@ -1209,13 +1925,38 @@ public:
               UPL_CONCEPT_REQUIRES_(IsConstIncorrect<Y>)>
     weak(StdSmart<Y, M>&& other) = delete;
 
+    // Aliasing constructors: the result observes the object of the other
+    // by the pointer p, e.g. to its member or element.
+    template <class Y, class M>
+    weak(const weak<Y, M>& other,
+         typename parent::element_type* p) noexcept (parent::IsOptional)
+        : parent{internal::aliasing_t{}, other, p}
+    { parent::check_alias(p); }
+
+    template <class Y, class M>
+    weak(weak<Y, M>&& other,
+         typename parent::element_type* p) noexcept (parent::IsOptional)
+        : parent{internal::aliasing_t{}, std::move(other), p}
+    { parent::check_alias(p); }
+
+    template <class Y, class M>
+    weak(const internal::strong<Y, M>& other,
+         typename parent::element_type* p) noexcept (parent::IsOptional)
+        : parent{internal::aliasing_t{}, other, p}
+    { parent::check_alias(p); }
+
+    template <class Y, class M>
+    weak(const unique<Y, M>& other, typename parent::element_type* p)
+        : parent{internal::aliasing_t{}, internal::attacher::share(other), p}
+    { parent::check_alias(p); }
+
     // Copy operators.
     weak& operator=(const weak& other) noexcept
     { return this->template operator=<weak, T, multiplicity_type>(other); }
 
     template <template <class Y, class M> class StdSmart, class Y, class M,
               UPL_CONCEPT_REQUIRES_(IsCompatible<Y>)>
-    weak& operator=(const StdSmart<Y, M>& other) noexcept
+    weak& operator=(const StdSmart<Y, M>& other) noexcept (!internal::IsBareOwner<StdSmart<Y, M>>)
     {
         weak{other}.swap(*this);
         return *this;
@@ -1278,11 +2019,19 @@ public:
               UPL_CONCEPT_REQUIRES_(IsConstIncorrect<Y>)>
     weak& operator=(StdSmart<Y, M>&& other) = delete;
 
-    unified<T, tag::optional> lock() const noexcept
-    { return unified<T, tag::optional>{parent::lock()}; }
+    unified<T, internal::Optional<Multiplicity>> lock() const noexcept
+    { return unified<T, internal::Optional<Multiplicity>>{parent::lock()}; }
 
     void swap(weak& other) noexcept (parent::IsOptional)
     { parent::swap(other); }
+
+private:
+    template <class Y>
+    weak(internal::weak_referrer<Y, internal::Policy<Multiplicity>>&& referrer) noexcept
+        : parent{std::move(referrer)} {}
+
+    template <class Y, class M>
+    friend class upl::enable_weak_from_this;
 };
 
 } // namespace detail
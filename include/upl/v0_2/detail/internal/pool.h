@@ -0,0 +1,436 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018-2019 Viktor Kireev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace upl
+{
+
+inline namespace v0_2
+{
+
+namespace detail
+{
+
+namespace internal
+{
+
+// Serves the blocks of one size from slabs. Each thread that allocates
+// takes a sub-pool, which carves the blocks from its own slabs and keeps
+// its own free list. A block that is freed by the thread of its slab goes
+// to the free list, a block that is freed by another thread is pushed to
+// the inbox of the slab owner, which picks the inbox up when its free list
+// is empty. The sub-pool of a finished thread is passed to the next thread
+// with its free blocks.
+//
+// The slabs are returned to the system when the pool is destroyed.
+class pool_base
+{
+public:
+    struct statistics
+    {
+        std::uint64_t live{0};         // Blocks held by the objects.
+        std::uint64_t peak{0};         // The high-water mark of the blocks, summed over the sub-pools.
+        std::uint64_t capacity{0};     // Blocks that the slabs can hold.
+        std::uint64_t slabs{0};        // Slabs taken from the system.
+        std::uint64_t sub_pools{0};    // Sub-pools taken by the threads.
+        std::uint64_t remote_frees{0}; // Blocks freed by another thread than the owner of their slab.
+
+        // The share of the slab memory that is held by the objects.
+        double occupancy() const noexcept
+        { return capacity ? double(live) / double(capacity) : 0.0; }
+
+        // The share of the carved blocks that are free, scattered
+        // between the blocks of the objects.
+        double fragmentation() const noexcept
+        { return peak ? double(peak - live) / double(peak) : 0.0; }
+
+        statistics& operator+=(const statistics& other) noexcept
+        {
+            live         += other.live;
+            peak         += other.peak;
+            capacity     += other.capacity;
+            slabs        += other.slabs;
+            sub_pools    += other.sub_pools;
+            remote_frees += other.remote_frees;
+            return *this;
+        }
+    };
+
+    static constexpr std::size_t SlabSize = 64 * 1024;
+
+    pool_base(const pool_base&) = delete;
+    pool_base& operator=(const pool_base&) = delete;
+
+    statistics stats() const noexcept
+    {
+        std::lock_guard<std::mutex> lock{m_mutex};
+
+        statistics result = m_orphan.collect(m_per_slab);
+        for (const sub_pool* s = m_head; s != nullptr; s = s->next)
+        {
+            result += s->collect(m_per_slab);
+            ++result.sub_pools;
+        }
+
+        return result;
+    }
+
+    // The statistics of the sub-pool of the current thread.
+    statistics this_thread() const noexcept
+    {
+        if (const sub_pool* own = find(this))
+        {
+            statistics result = own->collect(m_per_slab);
+            result.sub_pools  = 1;
+            return result;
+        }
+
+        return statistics{};
+    }
+
+protected:
+    pool_base(std::size_t size, std::size_t alignment)
+        : m_size{round_up(std::max(size, sizeof(block)), alignment)},
+          m_alignment{alignment},
+          m_first{round_up(sizeof(slab), alignment)},
+          m_per_slab{m_first < SlabSize ? (SlabSize - m_first) / m_size : 0},
+          m_id{next_id()}
+    {
+        registry&                   r = pools();
+        std::lock_guard<std::mutex> lock{r.mutex};
+        r.ids.insert(m_id);
+    }
+
+    ~pool_base()
+    {
+        {
+            registry&                   r = pools();
+            std::lock_guard<std::mutex> lock{r.mutex};
+            r.ids.erase(m_id);
+        }
+
+        assert(stats().live == 0 && "the objects of the pool must be released first");
+
+        m_orphan.free_slabs();
+        while (m_head)
+        {
+            sub_pool* s = std::exchange(m_head, m_head->next);
+            s->free_slabs();
+            delete s;
+        }
+    }
+
+    // Whether an allocation is served by the slabs, the others go to
+    // the operator new.
+    bool is_pooled(std::size_t size, std::size_t alignment) const noexcept
+    { return m_per_slab != 0 && size <= m_size && alignment <= m_alignment; }
+
+    void* allocate()
+    {
+        if (sub_pool* own = bind())
+            return own->allocate(*this);
+
+        std::lock_guard<std::mutex> lock{m_mutex};
+        return m_orphan.allocate(*this);
+    }
+
+    void deallocate(void* p) noexcept
+    {
+        block*    b     = ::new (p) block{nullptr};
+        sub_pool* owner = slab_of(p)->owner;
+
+        if (owner == find(this))
+            owner->release(b);
+        else
+            owner->receive(b);
+    }
+
+private:
+    struct block
+    { block* next; };
+
+    struct sub_pool;
+
+    struct slab
+    {
+        sub_pool* owner;
+        slab*     next;
+    };
+
+    // Only the owning thread writes the counter, the others may read it.
+    struct counter
+    {
+        std::atomic<std::uint64_t> value{0};
+
+        void operator++() noexcept
+        { value.store(value.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed); }
+
+        std::uint64_t load() const noexcept
+        { return value.load(std::memory_order_relaxed); }
+    };
+
+    struct sub_pool
+    {
+        void* allocate(const pool_base& pool)
+        {
+            if (free == nullptr)
+                free = inbox.exchange(nullptr, std::memory_order_acquire);
+
+            if (free == nullptr && bump == bump_end)
+            {
+                char* memory = static_cast<char*>(
+                    ::operator new(SlabSize, std::align_val_t{SlabSize}));
+                slabs_head = ::new (static_cast<void*>(memory)) slab{this, slabs_head};
+                bump       = memory + pool.m_first;
+                bump_end   = bump + pool.m_per_slab * pool.m_size;
+                ++slabs;
+            }
+
+            ++allocations;
+
+            if (free != nullptr)
+                return std::exchange(free, free->next);
+
+            ++carved;
+            return std::exchange(bump, bump + pool.m_size);
+        }
+
+        void release(block* b) noexcept
+        {
+            ++local_frees;
+            b->next = free;
+            free    = b;
+        }
+
+        void receive(block* b) noexcept
+        {
+            remote_frees.fetch_add(1, std::memory_order_relaxed);
+
+            block* head = inbox.load(std::memory_order_relaxed);
+            do
+                b->next = head;
+            while (!inbox.compare_exchange_weak(head, b,
+                                                std::memory_order_release,
+                                                std::memory_order_relaxed));
+        }
+
+        statistics collect(std::size_t per_slab) const noexcept
+        {
+            const std::uint64_t freed = local_frees.load()
+                                      + remote_frees.load(std::memory_order_relaxed);
+            const std::uint64_t taken = allocations.load();
+
+            statistics result;
+            result.live         = taken > freed ? taken - freed : 0;
+            result.peak         = std::max(carved.load(), result.live);
+            result.slabs        = slabs.load();
+            result.capacity     = result.slabs * per_slab;
+            result.remote_frees = remote_frees.load(std::memory_order_relaxed);
+            return result;
+        }
+
+        void free_slabs() noexcept
+        {
+            while (slabs_head)
+            {
+                slab* s = std::exchange(slabs_head, slabs_head->next);
+                ::operator delete(static_cast<void*>(s), std::align_val_t{SlabSize});
+            }
+        }
+
+        block* free{nullptr};
+        char*  bump{nullptr};
+        char*  bump_end{nullptr};
+        slab*  slabs_head{nullptr};
+
+        counter allocations;
+        counter local_frees;
+        counter carved;
+        counter slabs;
+
+        alignas(64) std::atomic<block*> inbox{nullptr};
+        std::atomic<std::uint64_t>      remote_frees{0};
+
+        sub_pool* next{nullptr};
+        bool      in_use{false};
+    };
+
+    // The ids of the live pools. A thread checks the id before it
+    // passes its sub-pool back, since the pool may be already destroyed.
+    struct registry
+    {
+        std::mutex                        mutex;
+        std::unordered_set<std::uint64_t> ids;
+    };
+
+    static registry& pools() noexcept
+    {
+        static registry* instance = new registry;
+        return *instance;
+    }
+
+    static std::uint64_t next_id() noexcept
+    {
+        static std::atomic<std::uint64_t> counter{0};
+        return counter.fetch_add(1, std::memory_order_relaxed) + 1;
+    }
+
+    struct binding
+    {
+        const pool_base* pool;
+        std::uint64_t    id;
+        sub_pool*        own;
+    };
+
+    enum class state : unsigned char { fresh, alive, finished };
+
+    // Keeps the bindings of a thread and passes its sub-pools back
+    // when the thread finishes.
+    struct thread_guard
+    {
+        ~thread_guard()
+        {
+            t_state = state::finished;
+
+            registry&                   r = pools();
+            std::lock_guard<std::mutex> lock{r.mutex};
+            for (const binding& b : bindings)
+            {
+                if (r.ids.count(b.id))
+                    b.pool->unbind(b.own);
+            }
+        }
+
+        std::vector<binding> bindings;
+    };
+
+    static sub_pool* find(const pool_base* pool) noexcept
+    {
+        if (t_state != state::alive)
+            return nullptr;
+
+        for (const binding& b : *t_bindings)
+        {
+            if (b.pool == pool && b.id == pool->m_id)
+                return b.own;
+        }
+
+        return nullptr;
+    }
+
+    // Returns the sub-pool of the current thread, taking one if needed,
+    // or nullptr if the thread is finishing.
+    sub_pool* bind()
+    {
+        if (sub_pool* own = find(this))
+            return own;
+
+        if (t_state == state::finished)
+            return nullptr;
+
+        if (t_state == state::fresh)
+        {
+            static thread_local thread_guard guard;
+            t_bindings = &guard.bindings;
+            t_state    = state::alive;
+        }
+
+        {
+            // Drops the bindings to the destroyed pools.
+            registry&                   r = pools();
+            std::lock_guard<std::mutex> lock{r.mutex};
+            t_bindings->erase(std::remove_if(t_bindings->begin(), t_bindings->end(),
+                                             [&](const binding& b)
+                                             { return r.ids.count(b.id) == 0; }),
+                              t_bindings->end());
+        }
+
+        t_bindings->reserve(t_bindings->size() + 1);
+
+        std::lock_guard<std::mutex> lock{m_mutex};
+
+        sub_pool* own = m_head;
+        while (own != nullptr && own->in_use)
+            own = own->next;
+
+        if (own == nullptr)
+        {
+            own       = new sub_pool;
+            own->next = m_head;
+            m_head    = own;
+        }
+
+        own->in_use = true;
+        t_bindings->push_back(binding{this, m_id, own});
+        return own;
+    }
+
+    void unbind(sub_pool* own) const noexcept
+    {
+        std::lock_guard<std::mutex> lock{m_mutex};
+        own->in_use = false;
+    }
+
+    static slab* slab_of(void* p) noexcept
+    {
+        return reinterpret_cast<slab*>(
+            reinterpret_cast<std::uintptr_t>(p) & ~(std::uintptr_t{SlabSize} - 1));
+    }
+
+    static constexpr std::size_t round_up(std::size_t size, std::size_t alignment) noexcept
+    { return (size + alignment - 1) / alignment * alignment; }
+
+    const std::size_t   m_size;
+    const std::size_t   m_alignment;
+    const std::size_t   m_first;
+    const std::size_t   m_per_slab;
+    const std::uint64_t m_id;
+
+    mutable std::mutex m_mutex;
+    sub_pool*          m_head{nullptr};
+    sub_pool           m_orphan; // Serves the finished threads, under the mutex.
+
+    static inline thread_local state                 t_state{state::fresh};
+    static inline thread_local std::vector<binding>* t_bindings{nullptr};
+};
+
+} // namespace internal
+
+} // namespace detail
+
+} // namespace v0_2
+
+} // namespace upl
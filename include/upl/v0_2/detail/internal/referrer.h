@@ -0,0 +1,976 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018-2019 Viktor Kireev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <upl/v0_2/utility/itself.h>
+
+#include "control.h"
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <new>
+
+#if __has_include(<memory_resource>)
+#include <memory_resource>
+#endif
+
+namespace upl
+{
+
+inline namespace v0_2
+{
+
+namespace detail
+{
+
+namespace internal
+{
+
+template <class T, class Policy = concurrent_policy>
+class strong_referrer;
+template <class T, class Policy = concurrent_policy>
+class weak_referrer;
+
+// Spreads the bits of a value over the whole hash, so the hashes of
+// the aligned addresses have no zero low bits. This is the finalizer
+// of the MurmurHash3.
+inline std::size_t mix_hash(std::uint64_t value) noexcept
+{
+    value ^= value >> 33;
+    value *= 0xff51afd7ed558ccdULL;
+    value ^= value >> 33;
+    value *= 0xc4ceb9fe1a85ec53ULL;
+    value ^= value >> 33;
+    return static_cast<std::size_t>(value);
+}
+
+inline std::size_t hash_address(const void* p) noexcept
+{ return mix_hash(reinterpret_cast<std::uintptr_t>(p)); }
+
+// A std::pmr::memory_resource* stands for the std::pmr::polymorphic_allocator.
+template <class Alloc>
+struct allocator
+{ using type = Alloc; };
+
+#if defined (__cpp_lib_memory_resource)
+template <class Resource>
+struct allocator<Resource*>
+{
+    static_assert(std::is_base_of_v<std::pmr::memory_resource, Resource>,
+                  "allocator is not defined for the pointer");
+
+    using type = std::pmr::polymorphic_allocator<std::byte>;
+};
+#endif
+
+template <class Alloc>
+using allocator_t = typename allocator<Alloc>::type;
+
+// Creates the block of an array from the arguments of an itself
+// constructor: [for_overwrite,] [std::align_val_t,] size [, value].
+template <class Block, bool Overwrite, class Alloc, class ... Value>
+inline Block* create_aligned_array(const Alloc& alloc, std::align_val_t alignment,
+                                   std::size_t size, const Value& ... value)
+{
+    static_assert(sizeof ... (Value) <= 1, "an array is filled with one value");
+    static_assert(!Overwrite || sizeof ... (Value) == 0,
+                  "an array for overwrite is not filled");
+
+    return Block::template create<Overwrite>(alloc, size,
+                                             static_cast<std::size_t>(alignment),
+                                             value ...);
+}
+
+template <class Block, bool Overwrite, class Alloc, class ... Value>
+inline Block* create_aligned_array(const Alloc& alloc,
+                                   std::size_t size, const Value& ... value)
+{
+    return create_aligned_array<Block, Overwrite>(alloc, std::align_val_t{1},
+                                                  size, value ...);
+}
+
+template <class Block, class Alloc, class ... Args>
+inline Block* create_array(const Alloc& alloc, for_overwrite_t, const Args& ... args)
+{ return create_aligned_array<Block, true>(alloc, args ...); }
+
+template <class Block, class Alloc, class ... Args>
+inline Block* create_array(const Alloc& alloc, const Args& ... args)
+{ return create_aligned_array<Block, false>(alloc, args ...); }
+
+// Returns the UPL control block that the std::shared_ptr holds, if any.
+template <class Policy, class Y>
+inline control<Policy>* upl_control(const std::shared_ptr<Y>& other) noexcept
+{
+    if constexpr (std::is_same_v<Policy, concurrent_policy>)
+        if (auto releaser = std::get_deleter<std_releaser>(other))
+            return releaser->block;
+
+    return nullptr;
+}
+
+// Keeps the control block of an object, which enables the weak pointers
+// to itself. The block is set, without counting, by the owner that creates it,
+// since the block outlives the object.
+template <class Policy>
+class weak_this_base
+{
+protected:
+    weak_this_base() noexcept = default;
+
+    weak_this_base(const weak_this_base&) noexcept {}
+    weak_this_base& operator=(const weak_this_base&) noexcept { return *this; }
+
+    ~weak_this_base() = default;
+
+    template <class T>
+    weak_referrer<T, Policy> weak_this(T* self) const noexcept
+    { return weak_referrer<T, Policy>{m_control ? self : nullptr, m_control}; }
+
+private:
+    template <class T, class P>
+    friend class strong_referrer;
+
+    mutable control<Policy>* m_control{nullptr};
+};
+
+// Selects the constructors of a referrer that defer the control block.
+struct bare_t
+{
+    explicit bare_t() = default;
+};
+
+// Describes the object of a bare owner, which has no control block yet.
+// The description is tagged into the pointer to the block, so the bare
+// owner takes no more space than the others.
+template <class Policy>
+struct bare_object
+{
+    void             (*dispose)(void* p) noexcept;
+    control<Policy>* (*attach)(void* p);
+    void*              deleter;
+};
+
+// A deleter without a state is made anew by the description,
+// so the bare owner keeps nothing of it. The description keeps
+// the deleter that is given out as the deleter of its objects.
+template <class D>
+inline constexpr bool IsStateless =
+    std::is_empty_v<D> && std::is_default_constructible_v<D>;
+
+template <class Y, class Policy, class D>
+inline D BareDeleter{};
+
+template <class Y, class Policy, class D = std::default_delete<Y>>
+inline constexpr bare_object<Policy> BareObject =
+{
+    [](void* p) noexcept { D{}(static_cast<Y*>(p)); },
+    [](void* p) -> control<Policy>*
+    {
+        return new pointer_control<Y*, D, Policy>{static_cast<Y*>(p), {}};
+    },
+    &BareDeleter<Y, Policy, D>
+};
+
+// Holds one use of a control block.
+// The sole owner of an object that is adopted from a raw pointer or
+// a std::unique_ptr may be bare: it releases the object until the block is
+// attached to it. The block is attached by the attach() before the owner
+// is copied, observed or converted the way that can't keep it bare, so
+// the copies and the moves themselves never allocate. Since a const owner
+// may be observed concurrently, the block is attached by
+// a compare-exchange, and the block of the loser is discarded.
+template <class T, class Policy>
+class strong_referrer
+{
+    using Control = control<Policy>;
+    using Bare    = bare_object<Policy>;
+
+    static constexpr std::uintptr_t BareTag = 1;
+
+    // Only the exact type is deleted by the description, and the objects
+    // that refer to their block keep it from the start.
+    template <class Y>
+    static constexpr bool IsBare =
+           !std::is_array_v<Y>
+        && std::is_same_v<std::remove_cv_t<Y>, std::remove_cv_t<T>>
+        && !std::is_convertible_v<Y*, const weak_this_base<Policy>*>;
+
+    template <class Y>
+    static constexpr bool IsBareConversion =
+        !std::is_array_v<T> && std::has_virtual_destructor_v<T>;
+
+public:
+    using element_type = std::remove_extent_t<T>;
+
+    constexpr strong_referrer() noexcept = default;
+
+    template <class Y, class ... Args>
+    explicit strong_referrer(itself_type_t<Y> itself, Args&& ... args)
+        : strong_referrer{std::allocator_arg, default_allocator<std::remove_extent_t<Y>>{},
+                          itself, std::forward<Args>(args) ...} {}
+
+    template <class Alloc, class Y, class ... Args>
+    strong_referrer(std::allocator_arg_t, const Alloc& alloc,
+                    itself_type_t<Y>, Args&& ... args)
+    {
+        if constexpr (std::is_array_v<Y>)
+        {
+            static_assert(std::extent_v<Y> == 0,
+                          "the size of an array is passed to the constructor");
+
+            using Block = array_control<std::remove_extent_t<Y>, allocator_t<Alloc>, Policy>;
+
+            auto block = create_array<Block>(allocator_t<Alloc>{alloc},
+                                             std::forward<Args>(args) ...);
+            m_pointer = block->pointer();
+            m_control = block;
+        }
+        else
+        {
+            using Block = inplace_control<Y, allocator_t<Alloc>, Policy>;
+
+            auto block = Block::create(allocator_t<Alloc>{alloc},
+                                       std::forward<Args>(args) ...);
+            m_pointer = block->pointer();
+            m_control = block;
+            enable_weak_this(block->pointer());
+        }
+    }
+
+    template <class Y, class ... Args>
+    strong_referrer(itself_isolated_t isolated, itself_type_t<Y> itself, Args&& ... args)
+        : strong_referrer{std::allocator_arg, default_allocator<Y>{},
+                          isolated, itself, std::forward<Args>(args) ...} {}
+
+    template <class Alloc, class Y, class ... Args>
+    strong_referrer(std::allocator_arg_t, const Alloc& alloc,
+                    itself_isolated_t, itself_type_t<Y>, Args&& ... args)
+    {
+        static_assert(!std::is_array_v<Y>,
+                      "the elements of an array are aligned by the std::align_val_t");
+
+        using Block = inplace_control<Y, allocator_t<Alloc>, Policy, true>;
+
+        auto block = Block::create(allocator_t<Alloc>{alloc},
+                                   std::forward<Args>(args) ...);
+        m_pointer = block->pointer();
+        m_control = block;
+        enable_weak_this(block->pointer());
+    }
+
+    template <class Y>
+    explicit strong_referrer(Y* p)
+        : strong_referrer{p, std::default_delete<Y>{}} {}
+
+    template <class Y, class D>
+    strong_referrer(Y* p, D d)
+    {
+        if (p == nullptr)
+            return;
+
+        try
+        {
+            m_control = new pointer_control<Y*, D, Policy>{p, d};
+            m_pointer = p;
+            enable_weak_this(p);
+        }
+        catch (...)
+        {
+            d(p);
+            throw;
+        }
+    }
+
+    template <class Y, class D>
+    strong_referrer(std::unique_ptr<Y, D>&& other)
+    {
+        using P = typename std::unique_ptr<Y, D>::pointer;
+        using E = std::conditional_t<std::is_reference_v<D>,
+                                     std::reference_wrapper<std::remove_reference_t<D>>,
+                                     D>;
+
+        if (!other)
+            return;
+
+        m_control = new pointer_control<P, E, Policy>{other.get(),
+                                                      std::forward<D>(other.get_deleter())};
+        enable_weak_this(other.get());
+        m_pointer = other.release();
+    }
+
+    // The bare constructors, which are chosen by a unique.
+    template <class Y, std::enable_if_t<IsBare<Y>, int> = 0>
+    strong_referrer(bare_t, Y* p) noexcept
+        : strong_referrer{bare_t{}, p, std::default_delete<Y>{}} {}
+
+    template <class Y, class D, std::enable_if_t<IsBare<Y> && IsStateless<D>, int> = 0>
+    strong_referrer(bare_t, Y* p, D) noexcept
+        : m_pointer{p}, m_control{p ? tag(&BareObject<std::remove_cv_t<Y>, Policy, D>) : nullptr} {}
+
+    template <class Y, class D,
+              std::enable_if_t<   IsBare<Y> && IsStateless<D>
+                               && std::is_same_v<typename std::unique_ptr<Y, D>::pointer, Y*>,
+                               int> = 0>
+    strong_referrer(bare_t, std::unique_ptr<Y, D>&& other) noexcept
+        : strong_referrer{bare_t{}, other.release(), D{}} {}
+
+    template <class Y>
+    strong_referrer(const std::shared_ptr<Y>& other)
+    {
+        if (!other)
+            return;
+
+        if (auto block = upl_control<Policy>(other))
+        {
+            UPL_STAT(std_unwrap, Policy::StatKind);
+            m_control = block;
+            m_control->add_use();
+        }
+        else
+        {
+            UPL_STAT(std_wrap, Policy::StatKind);
+            m_control = new std_control<Policy>{std::shared_ptr<const void>{other}};
+        }
+
+        m_pointer = other.get();
+    }
+
+    template <class Y>
+    strong_referrer(std::shared_ptr<Y>&& other)
+    {
+        if (!other)
+            return;
+
+        Y* p = other.get();
+
+        if (auto block = upl_control<Policy>(other))
+        {
+            UPL_STAT(std_unwrap, Policy::StatKind);
+            m_control = block;
+            m_control->add_use();
+            other.reset();
+        }
+        else
+        {
+            UPL_STAT(std_wrap, Policy::StatKind);
+            m_control = new std_control<Policy>{std::shared_ptr<const void>{std::move(other)}};
+        }
+
+        m_pointer = p;
+    }
+
+    template <class Y>
+    explicit strong_referrer(const std::weak_ptr<Y>& other)
+        : strong_referrer{std::shared_ptr<Y>{other}} {}
+
+    strong_referrer(const strong_referrer& other) noexcept
+        : m_pointer{other.m_pointer}, m_control{other.block()}
+    {
+        if (m_control)
+            m_control->add_use();
+    }
+
+    template <class Y>
+    strong_referrer(const strong_referrer<Y, Policy>& other) noexcept
+        : m_pointer{other.m_pointer}, m_control{other.block()}
+    {
+        if (m_control)
+            m_control->add_use();
+    }
+
+    // The control blocks of local and thread-safe pointers are not compatible.
+    template <class Y, class P>
+    strong_referrer(const strong_referrer<Y, P>& other) = delete;
+
+    strong_referrer(strong_referrer&& other) noexcept
+        : m_pointer{std::exchange(other.m_pointer, nullptr)},
+          m_control{std::exchange(other.m_control, nullptr)} {}
+
+    // A bare object stays bare only if it is deleted by the converted
+    // pointer, see the attach_converted().
+    template <class Y>
+    strong_referrer(strong_referrer<Y, Policy>&& other) noexcept
+    {
+        Control* block = other.m_control;
+        if constexpr (!std::is_same_v<std::remove_cv_t<Y>, std::remove_cv_t<T>>)
+        {
+            if (is_bare(block))
+            {
+                assert(other.template keeps_bare<T>());
+                block = tag(&BareObject<std::remove_cv_t<T>, Policy>);
+            }
+        }
+
+        m_pointer = std::exchange(other.m_pointer, nullptr);
+        m_control = block;
+        other.m_control = nullptr;
+    }
+
+    template <class Y, class P>
+    strong_referrer(strong_referrer<Y, P>&& other) = delete;
+
+    // Refer to the object of the other by the pointer p, which is its
+    // cast pointer or a pointer into it. A bare object stays bare only
+    // if the cast keeps its address and type, see the attach_aliased().
+    template <class Y>
+    strong_referrer(const strong_referrer<Y, Policy>& other, element_type* p) noexcept
+        : m_pointer{p}, m_control{other.block()}
+    {
+        if (m_control)
+            m_control->add_use();
+    }
+
+    template <class Y>
+    strong_referrer(strong_referrer<Y, Policy>&& other, element_type* p) noexcept
+    {
+        assert(!is_bare(other.m_control) || other.template keeps_bare<T>(p));
+
+        m_pointer = p;
+        m_control = other.m_control;
+        other.m_pointer = nullptr;
+        other.m_control = nullptr;
+    }
+
+    ~strong_referrer()
+    {
+        if (is_bare(m_control))
+            untag(m_control)->dispose(erase(m_pointer));
+        else if (m_control)
+            m_control->release();
+    }
+
+    strong_referrer& operator=(const strong_referrer& other) noexcept
+    {
+        strong_referrer{other}.swap(*this);
+        return *this;
+    }
+
+    strong_referrer& operator=(strong_referrer&& other) noexcept
+    {
+        strong_referrer{std::move(other)}.swap(*this);
+        return *this;
+    }
+
+    element_type* get() const noexcept { return m_pointer; }
+
+    explicit operator bool() const noexcept { return m_pointer != nullptr; }
+
+    void reset() noexcept { strong_referrer{}.swap(*this); }
+
+    void defer_destruction() const noexcept
+    {
+        if (auto block = this->block())
+            block->defer_destruction();
+    }
+
+    void swap(strong_referrer& other) noexcept
+    {
+        std::swap(m_pointer, other.m_pointer);
+        std::swap(m_control, other.m_control);
+    }
+
+    // The owners are keyed by the block, which is attached to a bare
+    // owner before, so the key does not change when it is observed later.
+    template <class U>
+    bool owner_before(const strong_referrer<U, Policy>& other) const noexcept
+    { return std::less<Control*>()(block(), other.block()); }
+
+    template <class U>
+    bool owner_before(const weak_referrer<U, Policy>& other) const noexcept
+    { return std::less<Control*>()(block(), other.m_control); }
+
+    template <class U>
+    bool owner_equal(const strong_referrer<U, Policy>& other) const noexcept
+    { return block() == other.block(); }
+
+    template <class U>
+    bool owner_equal(const weak_referrer<U, Policy>& other) const noexcept
+    { return block() == other.m_control; }
+
+    std::size_t owner_hash() const noexcept
+    { return hash_address(block()); }
+
+    long use_count() const noexcept
+    {
+        Control* block = load(m_control);
+        if (is_bare(block))
+            return 1;
+
+        return block ? block->use_count() : 0;
+    }
+
+    // The deleter of a bare owner is kept by the description of its object.
+    void* deleter() const noexcept
+    {
+        Control* block = load(m_control);
+        if (is_bare(block))
+            return untag(block)->deleter;
+
+        return block ? block->deleter() : nullptr;
+    }
+
+    std::shared_ptr<T> share() const &
+    {
+        static_assert(std::is_same_v<Policy, concurrent_policy>,
+                      "a local pointer can't be shared with the std::shared_ptr");
+
+        Control* block = attach();
+        if (!block)
+            return std::shared_ptr<T>{};
+
+        UPL_STAT(std_share, Policy::StatKind);
+
+        if (auto owner = block->std_owner())
+            return std::shared_ptr<T>{*owner, m_pointer};
+
+        block->add_use();
+        return std::shared_ptr<T>{m_pointer, std_releaser{block}};
+    }
+
+    std::shared_ptr<T> share() &&
+    {
+        static_assert(std::is_same_v<Policy, concurrent_policy>,
+                      "a local pointer can't be shared with the std::shared_ptr");
+
+        Control* block = attach();
+        if (!block)
+            return std::shared_ptr<T>{};
+
+        UPL_STAT(std_share, Policy::StatKind);
+
+        if (auto owner = block->std_owner())
+        {
+            std::shared_ptr<T> result{*owner, m_pointer};
+            reset();
+            return result;
+        }
+
+        m_control = nullptr;
+        return std::shared_ptr<T>{std::exchange(m_pointer, nullptr),
+                                  std_releaser{block}};
+    }
+
+    // Returns the block, which is attached to a bare owner at first.
+    Control* attach() const
+    {
+        Control* block = load(m_control);
+        if (!is_bare(block))
+            return block;
+
+        Control* attached = untag(block)->attach(erase(m_pointer));
+        if (compare_exchange(m_control, block, attached))
+            return attached;
+
+        attached->discard();
+        return block;
+    }
+
+    // Attaches the block to a bare owner, unless its object stays bare
+    // after the conversion to the strong_referrer<U>.
+    template <class U>
+    void attach_converted() const
+    {
+        if (is_bare(m_control) && !keeps_bare<U>())
+            attach();
+    }
+
+    // The same for the conversion, which refers to the object by the p.
+    template <class U>
+    void attach_aliased(const std::remove_extent_t<U>* p) const
+    {
+        if (is_bare(m_control) && !keeps_bare<U>(p))
+            attach();
+    }
+
+private:
+    strong_referrer(element_type* p, Control* block) noexcept
+        : m_pointer{p}, m_control{block} {}
+
+    // Returns the block of an owner, which is not bare: it is attached
+    // before the owner is copied, observed, ordered or hashed.
+    Control* block() const noexcept
+    {
+        Control* block = load(m_control);
+        assert(!is_bare(block));
+        return block;
+    }
+
+    // The object of a custom deleter is deleted only as its own type,
+    // the others may be deleted through a base with a virtual destructor.
+    template <class U>
+    bool keeps_bare() const noexcept
+    {
+        using Object = std::remove_cv_t<U>;
+        using Source = std::remove_cv_t<T>;
+
+        if constexpr (std::is_same_v<Source, Object>)
+            return true;
+        else if constexpr (strong_referrer<U, Policy>::template IsBareConversion<T>)
+            return untag(m_control) == &BareObject<Source, Policy>;
+        else
+            return false;
+    }
+
+    template <class U>
+    bool keeps_bare(const std::remove_extent_t<U>* p) const noexcept
+    {
+        if constexpr (std::is_same_v<std::remove_cv_t<U>, std::remove_cv_t<T>>)
+            return p == m_pointer;
+        else
+            return false;
+    }
+
+    static Control* tag(const Bare* bare) noexcept
+    { return reinterpret_cast<Control*>(reinterpret_cast<std::uintptr_t>(bare) | BareTag); }
+
+    static const Bare* untag(Control* block) noexcept
+    { return reinterpret_cast<const Bare*>(reinterpret_cast<std::uintptr_t>(block) & ~BareTag); }
+
+    static bool is_bare(Control* block) noexcept
+    { return reinterpret_cast<std::uintptr_t>(block) & BareTag; }
+
+    static void* erase(element_type* p) noexcept
+    { return const_cast<void*>(static_cast<const volatile void*>(p)); }
+
+    // The readers of a shared owner may attach its block concurrently,
+    // so they access the block as the std::atomic_ref does, while the owner
+    // that changes the block otherwise is not shared.
+    static Control* load(Control* const& block) noexcept
+    {
+        if constexpr (std::is_same_v<Policy, concurrent_policy>)
+        {
+#if defined (__GNUC__)
+            return __atomic_load_n(&block, __ATOMIC_ACQUIRE);
+#else
+            return reinterpret_cast<const std::atomic<Control*>&>(block)
+                       .load(std::memory_order_acquire);
+#endif
+        }
+        else
+        {
+            return block;
+        }
+    }
+
+    static bool compare_exchange(Control*& block, Control*& expected,
+                                 Control* desired) noexcept
+    {
+        if constexpr (std::is_same_v<Policy, concurrent_policy>)
+        {
+#if defined (__GNUC__)
+            return __atomic_compare_exchange_n(&block, &expected, desired, false,
+                                               __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+#else
+            return reinterpret_cast<std::atomic<Control*>&>(block)
+                       .compare_exchange_strong(expected, desired,
+                                                std::memory_order_acq_rel,
+                                                std::memory_order_acquire);
+#endif
+        }
+        else
+        {
+            block = desired;
+            return true;
+        }
+    }
+
+    // The object owned by the std::shared_ptr may outlive its block,
+    // so only the blocks that own the object are kept.
+    template <class Y>
+    void enable_weak_this(Y* p) const noexcept
+    {
+        if constexpr (std::is_convertible_v<Y*, const weak_this_base<Policy>*>)
+        {
+            const weak_this_base<Policy>* base = p;
+            if (!base->m_control)
+                base->m_control = m_control;
+        }
+    }
+
+    template <class Y, class P>
+    friend class strong_referrer;
+    template <class Y, class P>
+    friend class weak_referrer;
+
+    element_type*    m_pointer{nullptr};
+    mutable Control* m_control{nullptr};
+};
+
+// Holds one weak reference to a control block.
+template <class T, class Policy>
+class weak_referrer
+{
+    using Control = control<Policy>;
+
+public:
+    using element_type = std::remove_extent_t<T>;
+
+    constexpr weak_referrer() noexcept = default;
+
+    template <class Y>
+    weak_referrer(const strong_referrer<Y, Policy>& other) noexcept
+        : m_pointer{other.m_pointer}, m_control{other.block()}
+    {
+        if (m_control)
+            m_control->add_weak();
+    }
+
+    template <class Y, class P>
+    weak_referrer(const strong_referrer<Y, P>& other) = delete;
+
+    template <class Y>
+    weak_referrer(const std::shared_ptr<Y>& other)
+    {
+        if (!other)
+            return;
+
+        if (auto block = upl_control<Policy>(other))
+        {
+            UPL_STAT(std_unwrap, Policy::StatKind);
+            m_control = block;
+            m_control->add_weak();
+        }
+        else
+        {
+            UPL_STAT(std_wrap, Policy::StatKind);
+            m_control = new std_control<Policy>{std::weak_ptr<const void>{other}};
+        }
+
+        m_pointer = other.get();
+    }
+
+    template <class Y>
+    weak_referrer(const std::weak_ptr<Y>& other)
+        : weak_referrer{other.lock()} {}
+
+    weak_referrer(const weak_referrer& other) noexcept
+        : m_pointer{other.m_pointer}, m_control{other.m_control}
+    {
+        if (m_control)
+            m_control->add_weak();
+    }
+
+    // The conversion of a pointer to an expired object may access
+    // the object (a virtual base), so it is performed on a locked one.
+    template <class Y>
+    weak_referrer(const weak_referrer<Y, Policy>& other) noexcept
+        : m_pointer{other.lock().get()}, m_control{other.m_control}
+    {
+        if (m_control)
+            m_control->add_weak();
+    }
+
+    template <class Y, class P>
+    weak_referrer(const weak_referrer<Y, P>& other) = delete;
+
+    weak_referrer(weak_referrer&& other) noexcept
+        : m_pointer{std::exchange(other.m_pointer, nullptr)},
+          m_control{std::exchange(other.m_control, nullptr)} {}
+
+    // Refer to the block of the other by the pointer p.
+    template <class Y>
+    weak_referrer(const strong_referrer<Y, Policy>& other, element_type* p) noexcept
+        : weak_referrer{p, other.block()} {}
+
+    template <class Y>
+    weak_referrer(const weak_referrer<Y, Policy>& other, element_type* p) noexcept
+        : weak_referrer{p, other.m_control} {}
+
+    template <class Y>
+    weak_referrer(weak_referrer<Y, Policy>&& other, element_type* p) noexcept
+        : m_pointer{p}, m_control{std::exchange(other.m_control, nullptr)}
+    { other.m_pointer = nullptr; }
+
+    template <class Y>
+    weak_referrer(weak_referrer<Y, Policy>&& other) noexcept
+        : m_pointer{other.lock().get()},
+          m_control{std::exchange(other.m_control, nullptr)}
+    { other.m_pointer = nullptr; }
+
+    template <class Y, class P>
+    weak_referrer(weak_referrer<Y, P>&& other) = delete;
+
+    ~weak_referrer()
+    {
+        if (m_control)
+            m_control->release_weak();
+    }
+
+    weak_referrer& operator=(const weak_referrer& other) noexcept
+    {
+        weak_referrer{other}.swap(*this);
+        return *this;
+    }
+
+    weak_referrer& operator=(weak_referrer&& other) noexcept
+    {
+        weak_referrer{std::move(other)}.swap(*this);
+        return *this;
+    }
+
+    bool expired() const noexcept
+    { return m_control == nullptr || m_control->expired(); }
+
+    // The stored pointer, which is only compared: it dangles
+    // after the object expires.
+    element_type* get() const noexcept { return m_pointer; }
+
+    strong_referrer<T, Policy> lock() const & noexcept
+    {
+        UPL_STAT(lock, Policy::StatKind);
+
+        if (!m_control)
+        {
+            UPL_STAT(lock_failure, Policy::StatKind);
+            return strong_referrer<T, Policy>{};
+        }
+
+        if (m_control->try_add_use())
+            return strong_referrer<T, Policy>{m_pointer, m_control};
+
+        if (auto block = m_control->relock())
+            return strong_referrer<T, Policy>{m_pointer, block};
+
+        UPL_STAT(lock_failure, Policy::StatKind);
+        return strong_referrer<T, Policy>{};
+    }
+
+    // Locks the object by the weak reference itself, which is released
+    // in any case.
+    strong_referrer<T, Policy> lock() && noexcept
+    {
+        UPL_STAT(lock, Policy::StatKind);
+
+        if (!m_control)
+        {
+            UPL_STAT(lock_failure, Policy::StatKind);
+            return strong_referrer<T, Policy>{};
+        }
+
+        if (m_control->try_promote())
+            return strong_referrer<T, Policy>{std::exchange(m_pointer, nullptr),
+                                              std::exchange(m_control, nullptr)};
+
+        strong_referrer<T, Policy> result;
+        if (auto block = m_control->relock())
+            result = strong_referrer<T, Policy>{m_pointer, block};
+        else
+            UPL_STAT(lock_failure, Policy::StatKind);
+
+        reset();
+        return result;
+    }
+
+    // Calls the success_action for the object without changing its counts,
+    // meanwhile the object is protected by a hazard pointer. The object
+    // that is not protected this way is locked.
+    template <class SuccessAction, class FailureAction>
+    auto visit(SuccessAction&& success_action,
+               FailureAction&& failure_action) const
+    {
+        if constexpr (std::is_same_v<Policy, concurrent_policy>)
+        {
+            if (m_control)
+            {
+                if (auto slot = hazard::protect(m_control))
+                {
+                    struct guard
+                    {
+                        ~guard() { hazard::unprotect(slot); }
+                        hazard::slot* slot;
+                    } protection{slot};
+
+                    if (m_control->visit())
+                        return success_action(*m_pointer);
+                }
+            }
+        }
+
+        if (auto p = lock())
+            return success_action(*p.get());
+
+        return failure_action();
+    }
+
+    void reset() noexcept { weak_referrer{}.swap(*this); }
+
+    void swap(weak_referrer& other) noexcept
+    {
+        std::swap(m_pointer, other.m_pointer);
+        std::swap(m_control, other.m_control);
+    }
+
+    template <class U>
+    bool owner_before(const weak_referrer<U, Policy>& other) const noexcept
+    { return std::less<Control*>()(m_control, other.m_control); }
+
+    template <class U>
+    bool owner_equal(const strong_referrer<U, Policy>& other) const noexcept
+    { return m_control == other.block(); }
+
+    template <class U>
+    bool owner_equal(const weak_referrer<U, Policy>& other) const noexcept
+    { return m_control == other.m_control; }
+
+    std::size_t owner_hash() const noexcept
+    { return hash_address(m_control); }
+
+    long use_count() const noexcept
+    { return m_control ? m_control->use_count() : 0; }
+
+    template <class U>
+    bool owner_before(const strong_referrer<U, Policy>& other) const noexcept
+    { return std::less<Control*>()(m_control, other.block()); }
+
+private:
+    weak_referrer(element_type* p, Control* block) noexcept
+        : m_pointer{p}, m_control{block}
+    {
+        if (m_control)
+            m_control->add_weak();
+    }
+
+    template <class Y, class P>
+    friend class strong_referrer;
+    template <class Y, class P>
+    friend class weak_referrer;
+    template <class P>
+    friend class weak_this_base;
+
+    element_type* m_pointer{nullptr};
+    Control*      m_control{nullptr};
+};
+
+} // namespace internal
+
+} // namespace detail
+
+} // namespace v0_2
+
+} // namespace upl
@@ -0,0 +1,484 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018-2019 Viktor Kireev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <upl/v0_2/utility/itself.h>
+
+#include "referrer.h"
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace upl
+{
+
+inline namespace v0_2
+{
+
+template <class T>
+class slot_arena;
+
+namespace detail
+{
+
+namespace internal
+{
+
+// Counts the references inside the slots of a slot_arena.
+struct slot_policy
+{
+    static constexpr stats::kind StatKind = stats::kind::slot;
+};
+
+class slot_arena_base;
+
+// The header of a slot of a slot_arena. The generation is odd while
+// the slot holds an object and is increased when the object is created
+// and destroyed, so a weak reference, which remembers the generation,
+// is checked for the expiration by a single compare. The counts are not
+// atomic: an arena belongs to one thread.
+struct slot_header
+{
+    std::uint32_t    generation{0};
+    std::uint32_t    uses{0};
+    slot_arena_base* arena{nullptr};
+
+    void add_use() noexcept
+    {
+        UPL_STAT(add_use, stats::kind::slot);
+        ++uses;
+    }
+
+    void release() noexcept;
+};
+
+class slot_arena_base
+{
+public:
+    slot_arena_base(const slot_arena_base&) = delete;
+    slot_arena_base& operator=(const slot_arena_base&) = delete;
+
+    // Destroys the object of the slot and makes the slot free.
+    virtual void dispose(slot_header* header) noexcept = 0;
+
+protected:
+    slot_arena_base() = default;
+    ~slot_arena_base() = default;
+};
+
+inline void slot_header::release() noexcept
+{
+    UPL_STAT(release, stats::kind::slot);
+
+    if (--uses == 0)
+        arena->dispose(this);
+}
+
+using slot_key = std::pair<const void*, std::uint32_t>;
+
+inline bool slot_key_before(const slot_key& a, const slot_key& b) noexcept
+{
+    if (a.first != b.first)
+        return std::less<const void*>()(a.first, b.first);
+
+    return a.second < b.second;
+}
+
+inline std::size_t slot_key_hash(const slot_key& key) noexcept
+{ return mix_hash(hash_address(key.first) + key.second); }
+
+// Holds one use of an object in a slot.
+template <class T>
+class strong_referrer<T, slot_policy>
+{
+public:
+    using element_type = std::remove_extent_t<T>;
+
+    constexpr strong_referrer() noexcept = default;
+
+    template <class Y, class ... Args>
+    explicit strong_referrer(itself_type_t<Y>, Args&& ...)
+    {
+        static_assert(sizeof(Y) == -1,
+                      "a slot object is created in a slot_arena, "
+                      "pass it as 'std::allocator_arg, &arena'");
+    }
+
+    template <class Alloc, class Y, class ... Args>
+    strong_referrer(std::allocator_arg_t, const Alloc& arena,
+                    itself_type_t<Y>, Args&& ... args)
+    {
+        static_assert(std::is_same_v<Alloc, slot_arena<Y>*>,
+                      "a slot object is created in the slot_arena of its type");
+
+        UPL_STAT(itself_allocation, stats::kind::slot);
+
+        auto created = arena->emplace(std::forward<Args>(args) ...);
+        m_slot    = created.first;
+        m_pointer = created.second;
+    }
+
+    template <class ... Args>
+    strong_referrer(itself_isolated_t, Args&& ...)
+    {
+        static_assert(sizeof(T) == -1,
+                      "a slot object is placed in the slot_arena of its type");
+    }
+
+    template <class Y>
+    explicit strong_referrer(Y*)
+    {
+        static_assert(sizeof(Y) == -1,
+                      "a slot object can't be taken from a raw pointer");
+    }
+
+    template <class Y, class D>
+    strong_referrer(std::unique_ptr<Y, D>&&)
+    {
+        static_assert(sizeof(Y) == -1,
+                      "a slot object can't be taken from the std::unique_ptr");
+    }
+
+    template <class Y>
+    strong_referrer(const std::shared_ptr<Y>&)
+    {
+        static_assert(sizeof(Y) == -1,
+                      "a slot object can't be taken from the std::shared_ptr");
+    }
+
+    template <class Y>
+    explicit strong_referrer(const std::weak_ptr<Y>&)
+    {
+        static_assert(sizeof(Y) == -1,
+                      "a slot object can't be taken from the std::weak_ptr");
+    }
+
+    strong_referrer(const strong_referrer& other) noexcept
+        : m_pointer{other.m_pointer}, m_slot{other.m_slot}
+    {
+        if (m_slot)
+            m_slot->add_use();
+    }
+
+    template <class Y>
+    strong_referrer(const strong_referrer<Y, slot_policy>& other) noexcept
+        : m_pointer{other.m_pointer}, m_slot{other.m_slot}
+    {
+        if (m_slot)
+            m_slot->add_use();
+    }
+
+    template <class Y, class P>
+    strong_referrer(const strong_referrer<Y, P>& other) = delete;
+
+    strong_referrer(strong_referrer&& other) noexcept
+        : m_pointer{std::exchange(other.m_pointer, nullptr)},
+          m_slot{std::exchange(other.m_slot, nullptr)} {}
+
+    template <class Y>
+    strong_referrer(strong_referrer<Y, slot_policy>&& other) noexcept
+        : m_pointer{std::exchange(other.m_pointer, nullptr)},
+          m_slot{std::exchange(other.m_slot, nullptr)} {}
+
+    template <class Y, class P>
+    strong_referrer(strong_referrer<Y, P>&& other) = delete;
+
+    // Refer to the object of the other by its cast pointer p.
+    template <class Y>
+    strong_referrer(const strong_referrer<Y, slot_policy>& other, element_type* p) noexcept
+        : m_pointer{p}, m_slot{other.m_slot}
+    {
+        if (m_slot)
+            m_slot->add_use();
+    }
+
+    template <class Y>
+    strong_referrer(strong_referrer<Y, slot_policy>&& other, element_type* p) noexcept
+        : m_pointer{p}, m_slot{std::exchange(other.m_slot, nullptr)}
+    { other.m_pointer = nullptr; }
+
+    ~strong_referrer()
+    {
+        if (m_slot)
+            m_slot->release();
+    }
+
+    strong_referrer& operator=(const strong_referrer& other) noexcept
+    {
+        strong_referrer{other}.swap(*this);
+        return *this;
+    }
+
+    strong_referrer& operator=(strong_referrer&& other) noexcept
+    {
+        strong_referrer{std::move(other)}.swap(*this);
+        return *this;
+    }
+
+    element_type* get() const noexcept { return m_pointer; }
+
+    explicit operator bool() const noexcept { return m_pointer != nullptr; }
+
+    void reset() noexcept { strong_referrer{}.swap(*this); }
+
+    void swap(strong_referrer& other) noexcept
+    {
+        std::swap(m_pointer, other.m_pointer);
+        std::swap(m_slot, other.m_slot);
+    }
+
+    template <class U>
+    bool owner_before(const strong_referrer<U, slot_policy>& other) const noexcept
+    { return slot_key_before(key(), other.key()); }
+
+    template <class U>
+    bool owner_before(const weak_referrer<U, slot_policy>& other) const noexcept
+    { return slot_key_before(key(), other.key()); }
+
+    template <class U>
+    bool owner_equal(const strong_referrer<U, slot_policy>& other) const noexcept
+    { return key() == other.key(); }
+
+    template <class U>
+    bool owner_equal(const weak_referrer<U, slot_policy>& other) const noexcept
+    { return key() == other.key(); }
+
+    std::size_t owner_hash() const noexcept
+    { return slot_key_hash(key()); }
+
+    long use_count() const noexcept
+    { return m_slot ? long(m_slot->uses) : 0; }
+
+    std::shared_ptr<T> share() const
+    {
+        static_assert(sizeof(T) == -1,
+                      "a slot object can't be owned by the std::shared_ptr");
+        return {};
+    }
+
+private:
+    struct adopted_t {};
+
+    strong_referrer(adopted_t, element_type* p, slot_header* slot) noexcept
+        : m_pointer{p}, m_slot{slot} {}
+
+    // The slot is reused by other objects, so the owner is identified
+    // by the slot and its generation.
+    slot_key key() const noexcept
+    {
+        if (!m_slot)
+            return {nullptr, 0};
+
+        return {m_slot, m_slot->generation};
+    }
+
+    template <class Y, class P>
+    friend class strong_referrer;
+    template <class Y, class P>
+    friend class weak_referrer;
+
+    element_type* m_pointer{nullptr};
+    slot_header*  m_slot{nullptr};
+};
+
+// Refers to a slot and the generation of its object, so it neither
+// keeps the slot nor is counted by it.
+template <class T>
+class weak_referrer<T, slot_policy>
+{
+public:
+    using element_type = std::remove_extent_t<T>;
+
+    constexpr weak_referrer() noexcept = default;
+
+    template <class Y>
+    weak_referrer(const strong_referrer<Y, slot_policy>& other) noexcept
+        : m_pointer{other.m_pointer}, m_slot{other.m_slot},
+          m_generation{other.m_slot ? other.m_slot->generation : 0} {}
+
+    template <class Y, class P>
+    weak_referrer(const strong_referrer<Y, P>& other) = delete;
+
+    template <class Y>
+    weak_referrer(const std::shared_ptr<Y>&)
+    {
+        static_assert(sizeof(Y) == -1,
+                      "a slot object can't be observed through the std::shared_ptr");
+    }
+
+    template <class Y>
+    weak_referrer(const std::weak_ptr<Y>&)
+    {
+        static_assert(sizeof(Y) == -1,
+                      "a slot object can't be observed through the std::weak_ptr");
+    }
+
+    weak_referrer(const weak_referrer& other) noexcept = default;
+
+    // The conversion of a pointer to an expired object may access
+    // the object (a virtual base), so an expired one becomes empty.
+    template <class Y>
+    weak_referrer(const weak_referrer<Y, slot_policy>& other) noexcept
+    {
+        if (!other.expired())
+        {
+            m_pointer    = other.m_pointer;
+            m_slot       = other.m_slot;
+            m_generation = other.m_generation;
+        }
+    }
+
+    template <class Y, class P>
+    weak_referrer(const weak_referrer<Y, P>& other) = delete;
+
+    weak_referrer(weak_referrer&& other) noexcept
+        : m_pointer{std::exchange(other.m_pointer, nullptr)},
+          m_slot{std::exchange(other.m_slot, nullptr)},
+          m_generation{std::exchange(other.m_generation, 0)} {}
+
+    template <class Y>
+    weak_referrer(weak_referrer<Y, slot_policy>&& other) noexcept
+        : weak_referrer{static_cast<const weak_referrer<Y, slot_policy>&>(other)}
+    { other.reset(); }
+
+    // Refer to the slot of the other by the pointer p.
+    template <class Y>
+    weak_referrer(const strong_referrer<Y, slot_policy>& other, element_type* p) noexcept
+        : m_pointer{p}, m_slot{other.m_slot},
+          m_generation{other.m_slot ? other.m_slot->generation : 0} {}
+
+    template <class Y>
+    weak_referrer(const weak_referrer<Y, slot_policy>& other, element_type* p) noexcept
+        : m_pointer{p}, m_slot{other.m_slot}, m_generation{other.m_generation} {}
+
+    template <class Y>
+    weak_referrer(weak_referrer<Y, slot_policy>&& other, element_type* p) noexcept
+        : weak_referrer{static_cast<const weak_referrer<Y, slot_policy>&>(other), p}
+    { other.reset(); }
+
+    template <class Y, class P>
+    weak_referrer(weak_referrer<Y, P>&& other) = delete;
+
+    weak_referrer& operator=(const weak_referrer& other) noexcept = default;
+
+    weak_referrer& operator=(weak_referrer&& other) noexcept
+    {
+        weak_referrer{std::move(other)}.swap(*this);
+        return *this;
+    }
+
+    bool expired() const noexcept
+    { return m_slot == nullptr || m_slot->generation != m_generation; }
+
+    strong_referrer<T, slot_policy> lock() const & noexcept
+    {
+        using Strong = strong_referrer<T, slot_policy>;
+
+        UPL_STAT(lock, stats::kind::slot);
+
+        if (expired())
+        {
+            UPL_STAT(lock_failure, stats::kind::slot);
+            return Strong{};
+        }
+
+        m_slot->add_use();
+        return Strong{typename Strong::adopted_t{}, m_pointer, m_slot};
+    }
+
+    // The slot is not counted by the weak pointers, so there is nothing
+    // to pass from the weak reference to the owner.
+    strong_referrer<T, slot_policy> lock() && noexcept
+    {
+        auto result = static_cast<const weak_referrer&>(*this).lock();
+        reset();
+        return result;
+    }
+
+    template <class SuccessAction, class FailureAction>
+    auto visit(SuccessAction&& success_action,
+               FailureAction&& failure_action) const
+    {
+        if (auto p = lock())
+            return success_action(*p.get());
+
+        return failure_action();
+    }
+
+    void reset() noexcept { weak_referrer{}.swap(*this); }
+
+    void swap(weak_referrer& other) noexcept
+    {
+        std::swap(m_pointer, other.m_pointer);
+        std::swap(m_slot, other.m_slot);
+        std::swap(m_generation, other.m_generation);
+    }
+
+    template <class U>
+    bool owner_before(const weak_referrer<U, slot_policy>& other) const noexcept
+    { return slot_key_before(key(), other.key()); }
+
+    template <class U>
+    bool owner_equal(const strong_referrer<U, slot_policy>& other) const noexcept
+    { return key() == other.key(); }
+
+    template <class U>
+    bool owner_equal(const weak_referrer<U, slot_policy>& other) const noexcept
+    { return key() == other.key(); }
+
+    std::size_t owner_hash() const noexcept
+    { return slot_key_hash(key()); }
+
+    long use_count() const noexcept
+    { return expired() ? 0 : long(m_slot->uses); }
+
+    template <class U>
+    bool owner_before(const strong_referrer<U, slot_policy>& other) const noexcept
+    { return slot_key_before(key(), other.key()); }
+
+private:
+    slot_key key() const noexcept
+    { return {m_slot, m_generation}; }
+
+    template <class Y, class P>
+    friend class strong_referrer;
+    template <class Y, class P>
+    friend class weak_referrer;
+
+    element_type* m_pointer{nullptr};
+    slot_header*  m_slot{nullptr};
+    std::uint32_t m_generation{0};
+};
+
+} // namespace internal
+
+} // namespace detail
+
+} // namespace v0_2
+
+} // namespace upl
@@ -45,6 +45,11 @@ inline void swap(unique<T, Multiplicity>& a,
                  unique<T, Multiplicity>& b) noexcept (internal::IsOptional<Multiplicity>)
 { a.swap(b); }
 
+template <class T, class Multiplicity, class Deleter>
+inline void swap(custom_unique<T, Multiplicity, Deleter>& a,
+                 custom_unique<T, Multiplicity, Deleter>& b) noexcept (internal::IsOptional<Multiplicity>)
+{ a.swap(b); }
+
 template <class T, class Multiplicity>
 inline void swap(unified<T, Multiplicity>& a,
                  unified<T, Multiplicity>& b) noexcept (internal::IsOptional<Multiplicity>)
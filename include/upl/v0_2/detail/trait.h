@@ -49,6 +49,10 @@ template <class T, class Multiplicity>
 struct element<upl::detail::unique<T, Multiplicity>>
 { using type = typename upl::detail::unique<T, Multiplicity>::element_type; };
 
+template <class T, class Multiplicity, class Deleter>
+struct element<upl::detail::custom_unique<T, Multiplicity, Deleter>>
+    : public element<upl::detail::unique<T, Multiplicity>> {};
+
 template <class T, class Multiplicity>
 struct element<upl::detail::shared<T, Multiplicity>>
 { using type = typename upl::detail::shared<T, Multiplicity>::element_type; };
@@ -65,6 +69,10 @@ template <class T, class Multiplicity>
 struct ownership<upl::detail::unique<T, Multiplicity>>
 { using type = tag::unique; };
 
+template <class T, class Multiplicity, class Deleter>
+struct ownership<upl::detail::custom_unique<T, Multiplicity, Deleter>>
+{ using type = tag::unique; };
+
 template <class T, class Multiplicity>
 struct ownership<upl::detail::shared<T, Multiplicity>>
 { using type = tag::shared; };
@@ -81,6 +89,10 @@ template <class T, class Multiplicity_>
 struct multiplicity<upl::detail::unique<T, Multiplicity_>>
 { using type = Multiplicity_; };
 
+template <class T, class Multiplicity_, class Deleter>
+struct multiplicity<upl::detail::custom_unique<T, Multiplicity_, Deleter>>
+{ using type = Multiplicity_; };
+
 template <class T, class Multiplicity_>
 struct multiplicity<upl::detail::shared<T, Multiplicity_>>
 { using type = Multiplicity_; };
@@ -24,7 +24,10 @@
 
 #pragma once
 
+#include <upl/v0_2/utility/stats.h>
+
 #include <stdexcept>
+#include <string>
 
 namespace upl
 {
@@ -48,7 +51,13 @@ struct shared_error : public strong_error
 { using strong_error::strong_error; };
 
 struct single_error : public logic_error
-{ using logic_error::logic_error; };
+{
+    explicit single_error(const std::string& what) : logic_error{what}
+    { UPL_STAT(single_error, stats::kind::none); }
+
+    explicit single_error(const char* what) : logic_error{what}
+    { UPL_STAT(single_error, stats::kind::none); }
+};
 
 } // namespace v0_2
 
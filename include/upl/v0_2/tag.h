@@ -41,6 +41,10 @@ struct strong : public owner_based {};
 struct weak : public owner_based {};
 struct strict : public strong {};
 
+struct local {};
+struct intrusive {};
+struct slot {};
+
 } // namespace tag
 
 } // namespace internal
@@ -58,6 +62,33 @@ struct shared : public internal::tag::strict {};
 struct optional {};
 struct single {};
 
+namespace local
+{
+
+// Multiplicities of pointers that are owned by one thread.
+struct optional : public tag::optional, public internal::tag::local {};
+struct single : public tag::single, public internal::tag::local {};
+
+} // namespace local
+
+namespace intrusive
+{
+
+// Multiplicities of pointers to objects derived from the upl::intrusive_base.
+struct optional : public tag::optional, public internal::tag::intrusive {};
+struct single : public tag::single, public internal::tag::intrusive {};
+
+} // namespace intrusive
+
+namespace slot
+{
+
+// Multiplicities of pointers to objects kept in a upl::slot_arena.
+struct optional : public tag::optional, public internal::tag::slot {};
+struct single : public tag::single, public internal::tag::slot {};
+
+} // namespace slot
+
 } // namespace tag
 
 } // namespace v0_2
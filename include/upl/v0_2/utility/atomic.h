@@ -0,0 +1,50 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018-2019 Viktor Kireev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <upl/v0_2/detail/concrete.h>
+#include <upl/v0_2/detail/internal/atomic.h>
+
+namespace upl
+{
+
+inline namespace v0_2
+{
+
+// The atomic UPL pointers with the std::atomic interface: load, store,
+// exchange and compare_exchange. The readers take no lock. The atomic
+// 'single' pointer has no default constructor and never stores a null
+// pointer.
+template <class T, class Multiplicity = tag::optional>
+using atomic_shared =
+    detail::internal::atomic_pointer<detail::shared, T, Multiplicity>;
+
+template <class T, class Multiplicity = tag::optional>
+using atomic_weak =
+    detail::internal::atomic_pointer<detail::weak, T, Multiplicity>;
+
+} // namespace v0_2
+
+} // namespace upl
@@ -0,0 +1,694 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018-2019 Viktor Kireev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <upl/v0_2/concept.h>
+#include <upl/v0_2/detail/concrete.h>
+#include <upl/v0_2/utility/flat_owner.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <typeinfo>
+#include <utility>
+#include <vector>
+
+namespace upl
+{
+
+inline namespace v0_2
+{
+
+class tracer;
+
+// Enumerates the UPL pointer fields of an object tracked by
+// the cycle_collector, by default by its member trace(upl::tracer& t),
+// which passes the fields to the t. Specialize it for the types that
+// can't have the member.
+template <class T>
+struct tracing
+{
+    static void trace(T& object, tracer& t) { object.trace(t); }
+};
+
+namespace detail
+{
+
+namespace internal
+{
+
+// A tracked object, which is held by a pass of the collector.
+struct cycle_node
+{
+    virtual ~cycle_node() = default;
+
+    // Returns whether the object is alive, then it is held until unhold.
+    virtual bool hold() noexcept = 0;
+    virtual void unhold() noexcept = 0;
+
+    // The owners of the held object, except the collector.
+    virtual long owners() const noexcept = 0;
+    virtual const void* address() const noexcept = 0;
+    virtual void trace(tracer& t) = 0;
+
+    upl::weak<const void> key;
+    std::size_t      hash{0};
+    const char*      type{nullptr};
+    std::size_t      size{0};
+};
+
+template <class T>
+struct cycle_object final : cycle_node
+{
+    template <class P>
+    explicit cycle_object(const P& pointer)
+        : object{pointer}
+    {
+        key  = upl::weak<const void>{pointer};
+        hash = key.owner_hash();
+        type = typeid(T).name();
+        size = sizeof(T);
+    }
+
+    bool hold() noexcept override
+    {
+        held = object.lock();
+        return static_cast<bool>(held);
+    }
+
+    void unhold() noexcept override { held.reset(); }
+
+    long owners() const noexcept override { return held.use_count() - 1; }
+
+    const void* address() const noexcept override { return held.get(); }
+
+    void trace(tracer& t) override { tracing<T>::trace(*held, t); }
+
+    upl::weak<T>    object;
+    upl::unified<T> held;
+};
+
+// Looks up the nodes in the flat owner tables by any pointer
+// to the owner of their objects.
+struct cycle_key
+{
+    std::size_t owner_hash() const noexcept { return node->hash; }
+
+    bool owner_equal(const cycle_key& other) const noexcept
+    { return node == other.node; }
+
+    template <class P>
+    bool owner_equal(const P& pointer) const noexcept (noexcept(node->key.owner_equal(pointer)))
+    { return node->key.owner_equal(pointer); }
+
+    cycle_node* node;
+};
+
+using cycle_index = flat_owner_table<cycle_key, std::size_t>;
+
+} // namespace internal
+
+} // namespace detail
+
+// Passes the pointer fields of an object to the cycle_collector:
+// t(field_1, field_2, ...). The weak pointers may be passed, they are
+// skipped. Only the pointers that are shared between threads are traced.
+class tracer
+{
+public:
+    template <class ... P>
+    void operator()(P& ... fields) { (field(fields), ...); }
+
+private:
+    using index_type = detail::internal::cycle_index;
+
+    tracer(const index_type* index, std::vector<std::size_t>* edges) noexcept
+        : m_index{index}, m_edges{edges} {}
+
+    template <class P>
+    void field(P& pointer)
+    {
+        using F = std::remove_const_t<P>;
+
+        static_assert(Pointer<F>, "only the UPL pointers are traced");
+        static_assert(!LocalPointer<F> && !IntrusivePointer<F> && !SlotPointer<F>,
+                      "only the pointers shared between threads are traced");
+
+        if constexpr (StrongPointer<F>)
+        {
+            if (m_edges)
+            {
+                if (!pointer)
+                    return;
+
+                const std::size_t i = m_index->find(pointer);
+                if (i != m_index->capacity())
+                    m_edges->push_back(m_index->slot(i).second);
+            }
+            else if constexpr (OptionalPointer<F> && !std::is_const_v<P>)
+            {
+                // Breaks the cycle, a 'single' field can't be broken.
+                pointer = F{};
+            }
+        }
+    }
+
+    const index_type*         m_index;
+    std::vector<std::size_t>* m_edges;
+
+    friend class cycle_collector;
+};
+
+// Finds the garbage cycles of the upl::shared objects: the objects that
+// are owned only by each other. The tracked objects are registered by
+// track(pointer), and their types enumerate the pointer fields by
+// the upl::tracing. A pass holds the tracked objects, traces them in
+// parallel and subtracts the owners they have inside the tracked graph
+// from their use counts. The objects left with owners outside the graph
+// are the roots; the objects not reachable from the roots, marked
+// in parallel too, are the garbage. The detect() reports the strongly
+// connected components of the garbage that form cycles, and the collect()
+// also breaks them by resetting the traced fields of the garbage objects.
+//
+// The tracing must be synchronized with the changes of the fields,
+// otherwise the passes should run when the traced graph does not change.
+// Before the cycles are broken, the use counts of the garbage objects are
+// checked again, and if an object got a new owner meanwhile, for example
+// by locking a weak pointer, nothing is collected by the pass.
+class cycle_collector
+{
+public:
+    struct object_info
+    {
+        const char* type;    // The std::type_info::name of the object.
+        std::size_t size;    // The sizeof of the object.
+        const void* address;
+    };
+
+    struct cycle
+    {
+        std::vector<object_info> objects;
+        std::size_t              bytes{0};
+    };
+
+    struct report
+    {
+        std::size_t        tracked{0};       // The alive tracked objects.
+        std::size_t        garbage{0};       // The objects unreachable from outside.
+        std::size_t        garbage_bytes{0};
+        std::size_t        collected{0};     // The garbage objects destroyed.
+        bool               changed{false};   // The graph changed, nothing collected.
+        std::vector<cycle> cycles;
+    };
+
+    explicit cycle_collector(unsigned threads = std::thread::hardware_concurrency())
+        : m_threads{std::max(threads, 1u)} {}
+
+    cycle_collector(const cycle_collector&) = delete;
+    cycle_collector& operator=(const cycle_collector&) = delete;
+
+    ~cycle_collector() { stop(); }
+
+    // Tracks the object of the pointer until it is destroyed.
+    // Returns false if the object is tracked already.
+    template <class P>
+    bool track(const P& pointer)
+    {
+        static_assert(StrongPointer<P>, "the objects are tracked by the strong pointers");
+        static_assert(!LocalPointer<P> && !IntrusivePointer<P> && !SlotPointer<P>,
+                      "only the objects shared between threads are tracked");
+
+        using T = std::remove_const_t<trait::element_t<P>>;
+        static_assert(!std::is_array_v<T>, "the arrays are not tracked");
+
+        if (!pointer)
+            return false;
+
+        std::lock_guard<std::mutex> lock{m_mutex};
+        if (m_index.find(pointer) != m_index.capacity())
+            return false;
+
+        m_nodes.push_back(std::make_unique<detail::internal::cycle_object<T>>(pointer));
+        try
+        {
+            const key_type key{m_nodes.back().get()};
+            m_index.find_or_emplace(key, key);
+        }
+        catch (...)
+        {
+            m_nodes.pop_back();
+            throw;
+        }
+
+        return true;
+    }
+
+    // The tracked objects, including the destroyed ones not dropped yet.
+    std::size_t size() const
+    {
+        std::lock_guard<std::mutex> lock{m_mutex};
+        return m_nodes.size();
+    }
+
+    report detect() { return pass(false); }
+    report collect() { return pass(true); }
+
+    // Collects the cycles in the background with the period.
+    void start(std::chrono::milliseconds period)
+    {
+        stop();
+
+        m_stop   = false;
+        m_thread = std::thread{[this, period]
+        {
+            std::unique_lock<std::mutex> lock{m_background_mutex};
+            while (!m_wake.wait_for(lock, period, [this] { return m_stop; }))
+            {
+                lock.unlock();
+                report result;
+                try
+                {
+                    result = collect();
+                }
+                catch (...)
+                {
+                }
+
+                lock.lock();
+                m_last = std::move(result);
+            }
+        }};
+    }
+
+    void stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock{m_background_mutex};
+            m_stop = true;
+        }
+
+        m_wake.notify_all();
+        if (m_thread.joinable())
+            m_thread.join();
+    }
+
+    // The report of the last background pass.
+    report last_report() const
+    {
+        std::lock_guard<std::mutex> lock{m_background_mutex};
+        return m_last;
+    }
+
+private:
+    using node_type  = detail::internal::cycle_node;
+    using key_type   = detail::internal::cycle_key;
+    using index_type = detail::internal::cycle_index;
+
+    static constexpr std::size_t Chunk = 256;
+
+    // Releases the objects held by a pass.
+    struct holder
+    {
+        ~holder()
+        {
+            for (std::size_t i = 0; i < nodes.size(); ++i)
+            {
+                if (alive[i])
+                    nodes[i]->unhold();
+            }
+        }
+
+        std::vector<node_type*> nodes;
+        std::vector<char>       alive;
+    };
+
+    // The edges of the traced objects. Each thread appends the edges
+    // to its own buffer.
+    struct edge_list
+    {
+        struct range
+        {
+            std::size_t buffer{0};
+            std::size_t first{0};
+            std::size_t last{0};
+        };
+
+        struct view
+        {
+            const std::size_t* begin() const noexcept { return first; }
+            const std::size_t* end() const noexcept   { return last; }
+
+            const std::size_t* first;
+            const std::size_t* last;
+        };
+
+        edge_list(std::size_t nodes, std::size_t threads)
+            : buffers(threads), ranges(nodes) {}
+
+        view operator[](std::size_t i) const noexcept
+        {
+            const range&       r    = ranges[i];
+            const std::size_t* data = buffers[r.buffer].data();
+            return {data + r.first, data + r.last};
+        }
+
+        std::vector<std::vector<std::size_t>> buffers;
+        std::vector<range>                    ranges;
+    };
+
+    // Calls the body(i, thread) for the indices below the n by the chunks,
+    // in the current thread and the helper threads, numbered from 0.
+    template <class Body>
+    void parallel_for(std::size_t n, Body body) const
+    {
+        std::atomic<std::size_t> next{0};
+        std::exception_ptr       error;
+        std::mutex               error_mutex;
+
+        const auto work = [&](std::size_t thread)
+        {
+            try
+            {
+                for (;;)
+                {
+                    const std::size_t begin = next.fetch_add(Chunk, std::memory_order_relaxed);
+                    if (begin >= n)
+                        return;
+
+                    const std::size_t end = std::min(n, begin + Chunk);
+                    for (std::size_t i = begin; i < end; ++i)
+                        body(i, thread);
+                }
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lock{error_mutex};
+                if (!error)
+                    error = std::current_exception();
+
+                next.store(n, std::memory_order_relaxed);
+            }
+        };
+
+        const std::size_t helpers = std::min<std::size_t>(m_threads, (n + Chunk - 1) / Chunk);
+
+        std::vector<std::thread> threads;
+        for (std::size_t t = 1; t < helpers; ++t)
+            threads.emplace_back(work, t);
+
+        work(0);
+        for (auto& thread : threads)
+            thread.join();
+
+        if (error)
+            std::rethrow_exception(error);
+    }
+
+    report pass(bool collect)
+    {
+        std::lock_guard<std::mutex> pass_lock{m_pass_mutex};
+
+        holder held;
+        {
+            std::lock_guard<std::mutex> lock{m_mutex};
+            held.nodes.reserve(m_nodes.size());
+            for (const auto& node : m_nodes)
+                held.nodes.push_back(node.get());
+        }
+
+        const std::size_t        n     = held.nodes.size();
+        std::vector<node_type*>& nodes = held.nodes;
+
+        report result;
+        held.alive.assign(n, 0);
+        index_type index;
+        index.reserve(n);
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            if (!nodes[i]->hold())
+                continue;
+
+            held.alive[i] = 1;
+            index.find_or_emplace(key_type{nodes[i]}, key_type{nodes[i]}, i);
+            ++result.tracked;
+        }
+
+        const std::vector<char>& alive = held.alive;
+
+        // The owners outside the tracked graph.
+        edge_list edges{n, m_threads};
+        std::unique_ptr<std::atomic<long>[]>  refs{new std::atomic<long>[n]};
+        for (std::size_t i = 0; i < n; ++i)
+            refs[i].store(alive[i] ? nodes[i]->owners() : 0, std::memory_order_relaxed);
+
+        parallel_for(n, [&](std::size_t i, std::size_t thread)
+        {
+            if (!alive[i])
+                return;
+
+            std::vector<std::size_t>& buffer = edges.buffers[thread];
+            const std::size_t         first  = buffer.size();
+
+            tracer t{&index, &buffer};
+            nodes[i]->trace(t);
+            for (std::size_t e = first; e < buffer.size(); ++e)
+                refs[buffer[e]].fetch_sub(1, std::memory_order_relaxed);
+
+            edges.ranges[i] = {thread, first, buffer.size()};
+        });
+
+        // Marks the objects reachable from the roots.
+        std::unique_ptr<std::atomic<bool>[]> marked{new std::atomic<bool>[n]};
+        for (std::size_t i = 0; i < n; ++i)
+            marked[i].store(false, std::memory_order_relaxed);
+
+        const auto mark = [&](std::size_t j)
+        {
+            return !marked[j].load(std::memory_order_relaxed)
+                && !marked[j].exchange(true, std::memory_order_relaxed);
+        };
+
+        parallel_for(n, [&](std::size_t i, std::size_t)
+        {
+            if (!alive[i] || refs[i].load(std::memory_order_relaxed) <= 0 || !mark(i))
+                return;
+
+            std::vector<std::size_t> stack{i};
+            while (!stack.empty())
+            {
+                const std::size_t j = stack.back();
+                stack.pop_back();
+                for (std::size_t k : edges[j])
+                {
+                    if (mark(k))
+                        stack.push_back(k);
+                }
+            }
+        });
+
+        std::vector<char> garbage(n, 0);
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            if (alive[i] && !marked[i].load(std::memory_order_relaxed))
+            {
+                garbage[i] = 1;
+                ++result.garbage;
+                result.garbage_bytes += nodes[i]->size;
+            }
+        }
+
+        if (result.garbage == 0)
+            return finish(held, garbage, std::move(result));
+
+        find_cycles(nodes, edges, garbage, result);
+
+        if (collect)
+        {
+            // An object that got an owner outside the garbage is alive.
+            std::vector<long> inner(n, 0);
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                if (garbage[i])
+                {
+                    for (std::size_t j : edges[i])
+                        inner[j] += garbage[j];
+                }
+            }
+
+            for (std::size_t i = 0; i < n && !result.changed; ++i)
+                result.changed = garbage[i] && nodes[i]->owners() != inner[i];
+
+            if (!result.changed)
+            {
+                tracer breaker{nullptr, nullptr};
+                for (std::size_t i = 0; i < n; ++i)
+                {
+                    if (garbage[i])
+                        nodes[i]->trace(breaker);
+                }
+            }
+        }
+
+        return finish(held, garbage, std::move(result));
+    }
+
+    // Releases the held objects and drops the destroyed ones.
+    report finish(holder& held, const std::vector<char>& garbage, report result)
+    {
+        const std::vector<node_type*>& nodes = held.nodes;
+        for (std::size_t i = 0; i < nodes.size(); ++i)
+        {
+            if (held.alive[i])
+                nodes[i]->unhold();
+        }
+
+        held.alive.assign(nodes.size(), 0);
+
+        for (std::size_t i = 0; i < nodes.size(); ++i)
+        {
+            if (garbage[i] && nodes[i]->key.expired())
+                ++result.collected;
+        }
+
+        std::lock_guard<std::mutex> lock{m_mutex};
+        auto dead = std::partition(m_nodes.begin(), m_nodes.end(),
+                                   [](const std::unique_ptr<node_type>& node)
+                                   { return !node->key.expired(); });
+        for (auto it = dead; it != m_nodes.end(); ++it)
+            m_index.erase(m_index.find(key_type{it->get()}));
+
+        m_nodes.erase(dead, m_nodes.end());
+        return result;
+    }
+
+    // Reports the strongly connected components of the garbage that are
+    // cycles, by the iterative Tarjan's algorithm.
+    static void find_cycles(const std::vector<node_type*>& nodes,
+                            const edge_list& edges,
+                            const std::vector<char>& garbage, report& result)
+    {
+        constexpr std::size_t None = std::size_t(-1);
+
+        const std::size_t        n = nodes.size();
+        std::vector<std::size_t> order(n, None);
+        std::vector<std::size_t> low(n, 0);
+        std::vector<char>        on_stack(n, 0);
+        std::vector<std::size_t> stack;
+        std::size_t              counter = 0;
+
+        struct frame
+        {
+            std::size_t node;
+            std::size_t edge;
+        };
+
+        std::vector<frame> calls;
+        for (std::size_t root = 0; root < n; ++root)
+        {
+            if (!garbage[root] || order[root] != None)
+                continue;
+
+            calls.push_back({root, 0});
+            while (!calls.empty())
+            {
+                frame& f = calls.back();
+                const std::size_t v = f.node;
+                if (f.edge == 0 && order[v] == None)
+                {
+                    order[v] = low[v] = counter++;
+                    stack.push_back(v);
+                    on_stack[v] = 1;
+                }
+
+                const auto out = edges[v];
+                if (out.begin() + f.edge < out.end())
+                {
+                    const std::size_t w = out.begin()[f.edge++];
+                    if (!garbage[w])
+                        continue;
+
+                    if (order[w] == None)
+                        calls.push_back({w, 0});
+                    else if (on_stack[w])
+                        low[v] = std::min(low[v], order[w]);
+
+                    continue;
+                }
+
+                if (low[v] == order[v])
+                {
+                    cycle c;
+                    std::size_t w;
+                    do
+                    {
+                        w = stack.back();
+                        stack.pop_back();
+                        on_stack[w] = 0;
+                        c.objects.push_back({nodes[w]->type, nodes[w]->size,
+                                             nodes[w]->address()});
+                        c.bytes += nodes[w]->size;
+                    }
+                    while (w != v);
+
+                    const bool self = std::find(out.begin(), out.end(), v) != out.end();
+                    if (c.objects.size() > 1 || self)
+                        result.cycles.push_back(std::move(c));
+                }
+
+                calls.pop_back();
+                if (!calls.empty())
+                {
+                    const std::size_t parent = calls.back().node;
+                    low[parent] = std::min(low[parent], low[v]);
+                }
+            }
+        }
+    }
+
+    const unsigned m_threads;
+
+    mutable std::mutex                      m_mutex;
+    std::vector<std::unique_ptr<node_type>> m_nodes;
+    detail::internal::flat_owner_table<key_type, void> m_index;
+
+    std::mutex m_pass_mutex;
+
+    mutable std::mutex      m_background_mutex;
+    std::condition_variable m_wake;
+    std::thread             m_thread;
+    bool                    m_stop{false};
+    report                  m_last;
+};
+
+} // namespace v0_2
+
+} // namespace upl
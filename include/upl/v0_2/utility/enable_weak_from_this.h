@@ -0,0 +1,84 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018-2019 Viktor Kireev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <upl/v0_2/detail/concrete.h>
+
+namespace upl
+{
+
+inline namespace v0_2
+{
+
+// Allows an object, which is owned by the UPL pointers, to obtain
+// the weak pointers to itself. The object keeps the pointer to its control
+// block, which is set by the first owner without any allocation.
+// The objects owned by the std::shared_ptr are not supported, use
+// the std::enable_shared_from_this for them.
+template <class T, class Multiplicity = tag::optional>
+class enable_weak_from_this
+    : public detail::internal::weak_this_base<detail::internal::Policy<Multiplicity>>
+{
+    static_assert(!detail::internal::IsIntrusive<Multiplicity>,
+                  "an intrusive object can point to itself by a strong pointer");
+    static_assert(!detail::internal::IsSlot<Multiplicity>,
+                  "a slot object is observed by the generation of its slot");
+
+    using parent = detail::internal::weak_this_base<detail::internal::Policy<Multiplicity>>;
+
+    static constexpr bool IsOptional = detail::internal::IsOptional<Multiplicity>;
+
+public:
+    weak<T, Multiplicity> weak_from_this() noexcept (IsOptional)
+    { return make_weak(this->weak_this(static_cast<T*>(this))); }
+
+    weak<const T, Multiplicity> weak_from_this() const noexcept (IsOptional)
+    { return make_weak(this->weak_this(static_cast<const T*>(this))); }
+
+protected:
+    constexpr enable_weak_from_this() noexcept = default;
+
+    enable_weak_from_this(const enable_weak_from_this&) noexcept = default;
+    enable_weak_from_this& operator=(const enable_weak_from_this&) noexcept = default;
+
+    ~enable_weak_from_this() = default;
+
+private:
+    template <class Referrer>
+    static auto make_weak(Referrer&& referrer) noexcept (IsOptional)
+    {
+        using Weak = weak<typename Referrer::element_type, Multiplicity>;
+
+        if constexpr (!IsOptional)
+            if (referrer.expired())
+                throw single_error{"'single' is empty"};
+
+        return Weak{std::move(referrer)};
+    }
+};
+
+} // namespace v0_2
+
+} // namespace upl
@@ -0,0 +1,670 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018-2019 Viktor Kireev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <upl/v0_2/utility/owner.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace upl
+{
+
+inline namespace v0_2
+{
+
+namespace detail
+{
+
+namespace internal
+{
+
+// An open addressing table of the UPL pointers, which are keyed by their
+// owners. Each slot has a byte of metadata: whether the slot is empty or
+// erased, or the 7 high bits of the hash of its key, so most mismatches
+// are rejected without touching the keys. The slots are probed linearly,
+// and the table grows when 7/8 of it is used.
+template <class Key, class Mapped>
+class flat_owner_table
+{
+public:
+    using size_type = std::size_t;
+    using slot_type = std::conditional_t<std::is_void_v<Mapped>,
+                                         Key, std::pair<Key, Mapped>>;
+
+    static constexpr size_type MinCapacity = 16;
+
+    flat_owner_table() noexcept = default;
+
+    flat_owner_table(const flat_owner_table& other)
+    {
+        reserve(other.m_size);
+        for (size_type i = other.next(0); i != other.m_capacity; i = other.next(i + 1))
+            emplace_new(other.slot(i));
+    }
+
+    flat_owner_table(flat_owner_table&& other) noexcept
+        : m_meta{std::exchange(other.m_meta, nullptr)},
+          m_slots{std::exchange(other.m_slots, nullptr)},
+          m_capacity{std::exchange(other.m_capacity, 0)},
+          m_size{std::exchange(other.m_size, 0)},
+          m_erased{std::exchange(other.m_erased, 0)} {}
+
+    flat_owner_table& operator=(flat_owner_table other) noexcept
+    {
+        swap(other);
+        return *this;
+    }
+
+    ~flat_owner_table()
+    {
+        destroy_slots();
+        deallocate(m_meta, m_slots, m_capacity);
+    }
+
+    void swap(flat_owner_table& other) noexcept
+    {
+        std::swap(m_meta, other.m_meta);
+        std::swap(m_slots, other.m_slots);
+        std::swap(m_capacity, other.m_capacity);
+        std::swap(m_size, other.m_size);
+        std::swap(m_erased, other.m_erased);
+    }
+
+    size_type size() const noexcept     { return m_size; }
+    size_type capacity() const noexcept { return m_capacity; }
+
+    void clear() noexcept
+    {
+        destroy_slots();
+        if (m_meta)
+            std::memset(m_meta, Empty, m_capacity);
+
+        m_size   = 0;
+        m_erased = 0;
+    }
+
+    void reserve(size_type count)
+    {
+        if (count > max_load(m_capacity) - m_erased)
+            rehash(capacity_for(count));
+    }
+
+    // Whether the next insertion rehashes the table.
+    bool needs_rehash() const noexcept
+    { return m_size + m_erased + 1 > max_load(m_capacity); }
+
+    // The index of the first full slot from the index i, or the capacity.
+    size_type next(size_type i) const noexcept
+    {
+        while (i < m_capacity && !is_full(m_meta[i]))
+            ++i;
+
+        return i;
+    }
+
+    slot_type&       slot(size_type i) noexcept       { return m_slots[i]; }
+    const slot_type& slot(size_type i) const noexcept { return m_slots[i]; }
+
+    static const Key& key_of(const slot_type& s) noexcept
+    {
+        if constexpr (std::is_void_v<Mapped>)
+            return s;
+        else
+            return s.first;
+    }
+
+    // Whether a key of the K is looked up without throwing. Only a bare
+    // unique may throw here, when it gets its control block to be hashed.
+    template <class K>
+    static constexpr bool IsNothrowKey =
+           noexcept(std::declval<const K&>().owner_hash())
+        && noexcept(std::declval<const Key&>().owner_equal(std::declval<const K&>()));
+
+    // Returns the index of the slot with the owner of the key,
+    // or the capacity.
+    template <class K>
+    size_type find(const K& key) const noexcept (IsNothrowKey<K>)
+    {
+        if (m_size == 0)
+            return m_capacity;
+
+        const std::size_t  hash = key.owner_hash();
+        const std::uint8_t tag  = tag_of(hash);
+        const size_type    mask = m_capacity - 1;
+
+        for (size_type i = hash & mask;; i = (i + 1) & mask)
+        {
+            const std::uint8_t meta = m_meta[i];
+            if (meta == tag && key_of(m_slots[i]).owner_equal(key))
+                return i;
+
+            if (meta == Empty)
+                return m_capacity;
+        }
+    }
+
+    // Returns the index of the slot with the owner of the key. If there is
+    // no such slot, constructs one from the args and returns true.
+    template <class K, class ... Args>
+    std::pair<size_type, bool> find_or_emplace(const K& key, Args&& ... args)
+    {
+        if (needs_rehash())
+            rehash(capacity_for(m_size + 1));
+
+        const std::size_t  hash = key.owner_hash();
+        const std::uint8_t tag  = tag_of(hash);
+        const size_type    mask = m_capacity - 1;
+
+        size_type target = m_capacity;
+        for (size_type i = hash & mask;; i = (i + 1) & mask)
+        {
+            const std::uint8_t meta = m_meta[i];
+            if (meta == tag && key_of(m_slots[i]).owner_equal(key))
+                return {i, false};
+
+            if (meta == Erased && target == m_capacity)
+                target = i;
+
+            if (meta == Empty)
+            {
+                if (target == m_capacity)
+                    target = i;
+
+                break;
+            }
+        }
+
+        ::new (static_cast<void*>(m_slots + target)) slot_type(std::forward<Args>(args) ...);
+        if (m_meta[target] == Erased)
+            --m_erased;
+
+        m_meta[target] = tag;
+        ++m_size;
+        return {target, true};
+    }
+
+    void erase(size_type i) noexcept
+    {
+        m_slots[i].~slot_type();
+        --m_size;
+
+        // The probes stop at the next empty slot anyway.
+        if (m_meta[(i + 1) & (m_capacity - 1)] == Empty)
+        {
+            m_meta[i] = Empty;
+        }
+        else
+        {
+            m_meta[i] = Erased;
+            ++m_erased;
+        }
+    }
+
+private:
+    static constexpr std::uint8_t Empty  = 0x80;
+    static constexpr std::uint8_t Erased = 0xfe;
+
+    static bool is_full(std::uint8_t meta) noexcept
+    { return (meta & 0x80) == 0; }
+
+    static std::uint8_t tag_of(std::size_t hash) noexcept
+    { return static_cast<std::uint8_t>(hash >> (sizeof(std::size_t) * 8 - 7)); }
+
+    static size_type max_load(size_type capacity) noexcept
+    { return capacity / 8 * 7; }
+
+    static size_type capacity_for(size_type count)
+    {
+        size_type capacity = MinCapacity;
+        while (max_load(capacity) < count)
+        {
+            if (capacity > size_type(-1) / 2 / sizeof(slot_type))
+                throw std::length_error{"upl::flat_owner_table is too large"};
+
+            capacity *= 2;
+        }
+
+        return capacity;
+    }
+
+    // Moves the slots into a new table of the capacity, dropping
+    // the erased ones.
+    void rehash(size_type capacity)
+    {
+        std::uint8_t* meta  = static_cast<std::uint8_t*>(::operator new(capacity));
+        slot_type*    slots = nullptr;
+        try
+        {
+            slots = static_cast<slot_type*>(
+                ::operator new(capacity * sizeof(slot_type), std::align_val_t{alignof(slot_type)}));
+        }
+        catch (...)
+        {
+            ::operator delete(meta);
+            throw;
+        }
+
+        std::memset(meta, Empty, capacity);
+
+        const size_type mask = capacity - 1;
+        for (size_type i = next(0); i != m_capacity; i = next(i + 1))
+        {
+            const std::size_t hash = key_of(m_slots[i]).owner_hash();
+
+            size_type j = hash & mask;
+            while (meta[j] != Empty)
+                j = (j + 1) & mask;
+
+            ::new (static_cast<void*>(slots + j)) slot_type(std::move(m_slots[i]));
+            m_slots[i].~slot_type();
+            meta[j] = tag_of(hash);
+        }
+
+        deallocate(m_meta, m_slots, m_capacity);
+        m_meta     = meta;
+        m_slots    = slots;
+        m_capacity = capacity;
+        m_erased   = 0;
+    }
+
+    template <class Slot>
+    void emplace_new(const Slot& s)
+    { find_or_emplace(key_of(s), s); }
+
+    void destroy_slots() noexcept
+    {
+        if constexpr (!std::is_trivially_destructible_v<slot_type>)
+            for (size_type i = next(0); i != m_capacity; i = next(i + 1))
+                m_slots[i].~slot_type();
+    }
+
+    static void deallocate(std::uint8_t* meta, slot_type* slots, size_type) noexcept
+    {
+        if (!meta)
+            return;
+
+        ::operator delete(meta);
+        ::operator delete(static_cast<void*>(slots), std::align_val_t{alignof(slot_type)});
+    }
+
+    std::uint8_t* m_meta{nullptr};
+    slot_type*    m_slots{nullptr};
+    size_type     m_capacity{0};
+    size_type     m_size{0};
+    size_type     m_erased{0};
+};
+
+// Walks the full slots of a flat_owner_table.
+template <class Table, class View>
+class flat_owner_iterator
+{
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using difference_type   = std::ptrdiff_t;
+    using reference         = decltype(View{}(std::declval<Table&>().slot(0)));
+    using value_type        = std::remove_cv_t<std::remove_reference_t<reference>>;
+
+    // The pointer to a reference, which may be a pair of references.
+    struct pointer
+    {
+        reference value;
+
+        std::remove_reference_t<reference>* operator->() noexcept
+        { return std::addressof(value); }
+    };
+
+    flat_owner_iterator() noexcept = default;
+
+    flat_owner_iterator(Table* table, std::size_t index) noexcept
+        : m_table{table}, m_index{index} {}
+
+    template <class OtherTable, class OtherView,
+              class = std::enable_if_t<std::is_convertible_v<OtherTable*, Table*>>>
+    flat_owner_iterator(const flat_owner_iterator<OtherTable, OtherView>& other) noexcept
+        : m_table{other.m_table}, m_index{other.m_index} {}
+
+    reference operator*() const noexcept
+    { return View{}(m_table->slot(m_index)); }
+
+    auto operator->() const noexcept
+    {
+        if constexpr (std::is_reference_v<reference>)
+            return std::addressof(**this);
+        else
+            return pointer{**this};
+    }
+
+    flat_owner_iterator& operator++() noexcept
+    {
+        m_index = m_table->next(m_index + 1);
+        return *this;
+    }
+
+    flat_owner_iterator operator++(int) noexcept
+    {
+        flat_owner_iterator result = *this;
+        ++*this;
+        return result;
+    }
+
+    std::size_t index() const noexcept { return m_index; }
+
+    friend bool operator==(const flat_owner_iterator& a, const flat_owner_iterator& b) noexcept
+    { return a.m_index == b.m_index; }
+
+    friend bool operator!=(const flat_owner_iterator& a, const flat_owner_iterator& b) noexcept
+    { return a.m_index != b.m_index; }
+
+private:
+    template <class OtherTable, class OtherView>
+    friend class flat_owner_iterator;
+
+    Table*      m_table{nullptr};
+    std::size_t m_index{0};
+};
+
+} // namespace internal
+
+} // namespace detail
+
+// An unordered set of the UPL pointers with distinct owners. The owners are
+// compared by the owner_equal and hashed by the owner_hash, so a weak
+// pointer stays in its place after its object expires, and any pointer
+// to the same owner finds it. The keys are kept in one flat array with
+// the open addressing, which suits the sets of millions of pointers;
+// the iterators and the references are invalidated by the insertion.
+template <class Key>
+class flat_owner_set
+{
+    using table = detail::internal::flat_owner_table<Key, void>;
+
+    struct view
+    {
+        const Key& operator()(const Key& key) const noexcept { return key; }
+    };
+
+public:
+    using key_type       = Key;
+    using value_type     = Key;
+    using size_type      = std::size_t;
+    using hasher         = owner_hash;
+    using key_equal      = owner_equal;
+    using iterator       = detail::internal::flat_owner_iterator<const table, view>;
+    using const_iterator = iterator;
+
+    flat_owner_set() noexcept = default;
+
+    explicit flat_owner_set(size_type count)
+    { reserve(count); }
+
+    iterator begin() const noexcept { return {&m_table, m_table.next(0)}; }
+    iterator end() const noexcept   { return {&m_table, m_table.capacity()}; }
+
+    bool      empty() const noexcept    { return m_table.size() == 0; }
+    size_type size() const noexcept     { return m_table.size(); }
+    size_type capacity() const noexcept { return m_table.capacity(); }
+
+    float load_factor() const noexcept
+    { return capacity() ? float(size()) / float(capacity()) : 0.0f; }
+
+    void reserve(size_type count) { m_table.reserve(count); }
+    void clear() noexcept         { m_table.clear(); }
+
+    // Inserts a key if its owner is not in the set. The key is made
+    // from the pointer only if it is inserted.
+    template <class Pointer>
+    std::pair<iterator, bool> insert(Pointer&& pointer)
+    {
+        auto [index, inserted] = m_table.find_or_emplace(pointer, std::forward<Pointer>(pointer));
+        return {iterator{&m_table, index}, inserted};
+    }
+
+    template <class ... Args>
+    std::pair<iterator, bool> emplace(Args&& ... args)
+    { return insert(Key(std::forward<Args>(args) ...)); }
+
+    template <class Pointer>
+    iterator find(const Pointer& pointer) const noexcept (table::template IsNothrowKey<Pointer>)
+    { return {&m_table, m_table.find(pointer)}; }
+
+    template <class Pointer>
+    bool contains(const Pointer& pointer) const noexcept (table::template IsNothrowKey<Pointer>)
+    { return m_table.find(pointer) != m_table.capacity(); }
+
+    template <class Pointer>
+    size_type count(const Pointer& pointer) const noexcept (table::template IsNothrowKey<Pointer>)
+    { return contains(pointer) ? 1 : 0; }
+
+    void erase(const_iterator position) noexcept
+    { m_table.erase(position.index()); }
+
+    template <class Pointer, class = std::enable_if_t<!std::is_convertible_v<const Pointer&, const_iterator>>>
+    size_type erase(const Pointer& pointer) noexcept (table::template IsNothrowKey<Pointer>)
+    {
+        const size_type index = m_table.find(pointer);
+        if (index == m_table.capacity())
+            return 0;
+
+        m_table.erase(index);
+        return 1;
+    }
+
+    // Erases the keys that satisfy the predicate, for example, the expired
+    // weak pointers. Returns the number of the erased keys.
+    template <class Predicate>
+    size_type erase_if(Predicate predicate)
+    {
+        size_type erased = 0;
+        for (size_type i = m_table.next(0); i != m_table.capacity(); i = m_table.next(i + 1))
+        {
+            if (predicate(static_cast<const Key&>(m_table.slot(i))))
+            {
+                m_table.erase(i);
+                ++erased;
+            }
+        }
+
+        return erased;
+    }
+
+    void swap(flat_owner_set& other) noexcept
+    { m_table.swap(other.m_table); }
+
+private:
+    table m_table;
+};
+
+// An unordered map from the owners of the UPL pointers to the values,
+// see the flat_owner_set. Like the std::flat_map, the iterators yield
+// a pair of the references to the key and to the value.
+template <class Key, class T>
+class flat_owner_map
+{
+    using table = detail::internal::flat_owner_table<Key, T>;
+
+    struct view
+    {
+        std::pair<const Key&, T&> operator()(std::pair<Key, T>& s) const noexcept
+        { return {s.first, s.second}; }
+    };
+
+    struct const_view
+    {
+        std::pair<const Key&, const T&> operator()(const std::pair<Key, T>& s) const noexcept
+        { return {s.first, s.second}; }
+    };
+
+public:
+    using key_type        = Key;
+    using mapped_type     = T;
+    using value_type      = std::pair<Key, T>;
+    using reference       = std::pair<const Key&, T&>;
+    using const_reference = std::pair<const Key&, const T&>;
+    using size_type       = std::size_t;
+    using hasher          = owner_hash;
+    using key_equal       = owner_equal;
+    using iterator        = detail::internal::flat_owner_iterator<table, view>;
+    using const_iterator  = detail::internal::flat_owner_iterator<const table, const_view>;
+
+    flat_owner_map() noexcept = default;
+
+    explicit flat_owner_map(size_type count)
+    { reserve(count); }
+
+    iterator begin() noexcept             { return {&m_table, m_table.next(0)}; }
+    iterator end() noexcept               { return {&m_table, m_table.capacity()}; }
+    const_iterator begin() const noexcept { return {&m_table, m_table.next(0)}; }
+    const_iterator end() const noexcept   { return {&m_table, m_table.capacity()}; }
+
+    bool      empty() const noexcept    { return m_table.size() == 0; }
+    size_type size() const noexcept     { return m_table.size(); }
+    size_type capacity() const noexcept { return m_table.capacity(); }
+
+    float load_factor() const noexcept
+    { return capacity() ? float(size()) / float(capacity()) : 0.0f; }
+
+    void reserve(size_type count) { m_table.reserve(count); }
+    void clear() noexcept         { m_table.clear(); }
+
+    // Inserts a value constructed from the args if the owner of the pointer
+    // is not in the map. The key is made from the pointer only if it is
+    // inserted.
+    template <class Pointer, class ... Args>
+    std::pair<iterator, bool> try_emplace(Pointer&& pointer, Args&& ... args)
+    {
+        auto [index, inserted] = m_table.find_or_emplace(
+            pointer, std::piecewise_construct,
+            std::forward_as_tuple(std::forward<Pointer>(pointer)),
+            std::forward_as_tuple(std::forward<Args>(args) ...));
+        return {iterator{&m_table, index}, inserted};
+    }
+
+    template <class Pointer, class M>
+    std::pair<iterator, bool> insert_or_assign(Pointer&& pointer, M&& value)
+    {
+        auto result = try_emplace(std::forward<Pointer>(pointer), std::forward<M>(value));
+        if (!result.second)
+            result.first->second = std::forward<M>(value);
+
+        return result;
+    }
+
+    std::pair<iterator, bool> insert(value_type&& value)
+    { return try_emplace(std::move(value.first), std::move(value.second)); }
+
+    std::pair<iterator, bool> insert(const value_type& value)
+    { return try_emplace(value.first, value.second); }
+
+    template <class Pointer>
+    T& operator[](Pointer&& pointer)
+    { return try_emplace(std::forward<Pointer>(pointer)).first->second; }
+
+    template <class Pointer>
+    T& at(const Pointer& pointer)
+    {
+        const size_type index = m_table.find(pointer);
+        if (index == m_table.capacity())
+            throw std::out_of_range{"upl::flat_owner_map has no such owner"};
+
+        return m_table.slot(index).second;
+    }
+
+    template <class Pointer>
+    const T& at(const Pointer& pointer) const
+    { return const_cast<flat_owner_map&>(*this).at(pointer); }
+
+    template <class Pointer>
+    iterator find(const Pointer& pointer) noexcept (table::template IsNothrowKey<Pointer>)
+    { return {&m_table, m_table.find(pointer)}; }
+
+    template <class Pointer>
+    const_iterator find(const Pointer& pointer) const noexcept (table::template IsNothrowKey<Pointer>)
+    { return {&m_table, m_table.find(pointer)}; }
+
+    template <class Pointer>
+    bool contains(const Pointer& pointer) const noexcept (table::template IsNothrowKey<Pointer>)
+    { return m_table.find(pointer) != m_table.capacity(); }
+
+    template <class Pointer>
+    size_type count(const Pointer& pointer) const noexcept (table::template IsNothrowKey<Pointer>)
+    { return contains(pointer) ? 1 : 0; }
+
+    void erase(const_iterator position) noexcept
+    { m_table.erase(position.index()); }
+
+    void erase(iterator position) noexcept
+    { m_table.erase(position.index()); }
+
+    template <class Pointer,
+              class = std::enable_if_t<   !std::is_convertible_v<const Pointer&, const_iterator>
+                                       && !std::is_convertible_v<const Pointer&, iterator>>>
+    size_type erase(const Pointer& pointer) noexcept (table::template IsNothrowKey<Pointer>)
+    {
+        const size_type index = m_table.find(pointer);
+        if (index == m_table.capacity())
+            return 0;
+
+        m_table.erase(index);
+        return 1;
+    }
+
+    // Erases the entries, whose key and value satisfy the predicate.
+    // Returns the number of the erased entries.
+    template <class Predicate>
+    size_type erase_if(Predicate predicate)
+    {
+        size_type erased = 0;
+        for (size_type i = m_table.next(0); i != m_table.capacity(); i = m_table.next(i + 1))
+        {
+            auto& s = m_table.slot(i);
+            if (predicate(static_cast<const Key&>(s.first), s.second))
+            {
+                m_table.erase(i);
+                ++erased;
+            }
+        }
+
+        return erased;
+    }
+
+    void swap(flat_owner_map& other) noexcept
+    { m_table.swap(other.m_table); }
+
+private:
+    table m_table;
+};
+
+} // namespace v0_2
+
+} // namespace upl
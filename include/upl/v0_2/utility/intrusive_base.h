@@ -0,0 +1,76 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018-2019 Viktor Kireev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace upl
+{
+
+inline namespace v0_2
+{
+
+namespace detail
+{
+
+namespace internal
+{
+
+class intrusive_access;
+class intrusive_weak_block;
+struct intrusive_destruction;
+
+} // namespace internal
+
+} // namespace detail
+
+// The base of an object that counts its owners itself.
+// The 'intrusive' pointers refer to such an object by a single pointer
+// and do not allocate a control block for it.
+class intrusive_base
+{
+protected:
+    intrusive_base() noexcept = default;
+
+    // The counts belong to the object, so they are never copied.
+    intrusive_base(const intrusive_base&) noexcept {}
+    intrusive_base& operator=(const intrusive_base&) noexcept { return *this; }
+
+    ~intrusive_base() = default;
+
+private:
+    friend class detail::internal::intrusive_access;
+
+    using Destroy = const detail::internal::intrusive_destruction*;
+
+    mutable std::atomic<std::uint32_t> m_uses{0};
+    mutable Destroy                    m_destroy{nullptr};
+    mutable std::atomic<detail::internal::intrusive_weak_block*> m_weak{nullptr};
+};
+
+} // namespace v0_2
+
+} // namespace upl
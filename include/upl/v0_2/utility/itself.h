@@ -41,6 +41,20 @@ struct itself_type_t
     explicit itself_type_t() = default;
 };
 
+// Places the object that is created by the 'itself' constructor and
+// its control block in the different cache lines.
+struct itself_isolated_t
+{
+    explicit itself_isolated_t() = default;
+};
+
+// Requests the default-initialization of the elements of an array
+// instead of the value-initialization.
+struct for_overwrite_t
+{
+    explicit for_overwrite_t() = default;
+};
+
 namespace
 {
 
@@ -49,6 +63,10 @@ inline constexpr itself_t itself{};
 template <class T>
 inline constexpr itself_type_t<T> itself_type{};
 
+inline constexpr itself_isolated_t itself_isolated{};
+
+inline constexpr for_overwrite_t for_overwrite{};
+
 } // namespace
 
 } // namespace v0_2
@@ -0,0 +1,60 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018-2019 Viktor Kireev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstddef>
+
+namespace upl
+{
+
+inline namespace v0_2
+{
+
+// The hash of the owner of a UPL pointer, which is consistent with
+// the owner_equal and the owner_before. The weak pointers keep their
+// hash after the object expires, so they can be the keys of the
+// unordered containers.
+struct owner_hash
+{
+    using is_transparent = void;
+
+    template <class Pointer>
+    std::size_t operator()(const Pointer& pointer) const noexcept (noexcept(pointer.owner_hash()))
+    { return pointer.owner_hash(); }
+};
+
+// Whether the UPL pointers share an owner.
+struct owner_equal
+{
+    using is_transparent = void;
+
+    template <class A, class B>
+    bool operator()(const A& a, const B& b) const noexcept (noexcept(a.owner_equal(b)))
+    { return a.owner_equal(b); }
+};
+
+} // namespace v0_2
+
+} // namespace upl
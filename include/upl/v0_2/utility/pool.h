@@ -0,0 +1,126 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018-2019 Viktor Kireev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <upl/v0_2/detail/concrete.h>
+#include <upl/v0_2/detail/internal/pool.h>
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+
+namespace upl
+{
+
+inline namespace v0_2
+{
+
+// Serves the objects of one type and their control blocks from slabs.
+// The memory of an object and its block is one slab block, which goes
+// back to the pool when the last strong and weak pointers are released.
+// Each thread takes its own sub-pool, so the threads do not contend for
+// the free lists.
+//
+// The pool must outlive its objects and the weak pointers to them.
+template <class T>
+class pool : private detail::internal::pool_base
+{
+public:
+    // The standard allocator over the pool. The allocations that do not
+    // fit a block of the pool go to the operator new.
+    template <class U>
+    class allocator
+    {
+    public:
+        using value_type = U;
+
+        explicit allocator(pool& owner) noexcept
+            : m_pool{&owner} {}
+
+        template <class V>
+        allocator(const allocator<V>& other) noexcept
+            : m_pool{other.m_pool} {}
+
+        U* allocate(std::size_t n)
+        {
+            if (n == 1 && m_pool->is_pooled(sizeof(U), alignof(U)))
+                return static_cast<U*>(m_pool->pool_base::allocate());
+
+            if (n > std::size_t(-1) / sizeof(U))
+                throw std::bad_array_new_length{};
+
+            return static_cast<U*>(::operator new(n * sizeof(U), std::align_val_t{alignof(U)}));
+        }
+
+        void deallocate(U* p, std::size_t n) noexcept
+        {
+            if (n == 1 && m_pool->is_pooled(sizeof(U), alignof(U)))
+                m_pool->pool_base::deallocate(p);
+            else
+                ::operator delete(p, std::align_val_t{alignof(U)});
+        }
+
+        template <class V>
+        bool operator==(const allocator<V>& other) const noexcept
+        { return m_pool == other.m_pool; }
+
+        template <class V>
+        bool operator!=(const allocator<V>& other) const noexcept
+        { return m_pool != other.m_pool; }
+
+    private:
+        template <class V>
+        friend class allocator;
+
+        pool* m_pool;
+    };
+
+    using statistics = pool_base::statistics;
+    using pool_base::SlabSize;
+
+    pool()
+        : pool_base{sizeof(Block), alignof(Block)} {}
+
+    // Creates an object. The unique pointer can be converted
+    // to the shared one without a new allocation.
+    template <class ... Args>
+    unique<T> make(Args&& ... args)
+    { return unique<T>{std::allocator_arg, get_allocator(), itself, std::forward<Args>(args) ...}; }
+
+    allocator<T> get_allocator() noexcept
+    { return allocator<T>{*this}; }
+
+    using pool_base::stats;
+    using pool_base::this_thread;
+
+private:
+    using Block = detail::internal::inplace_control<T, allocator<T>,
+                                                    detail::internal::concurrent_policy>;
+};
+
+} // namespace v0_2
+
+} // namespace upl
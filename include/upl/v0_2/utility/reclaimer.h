@@ -0,0 +1,296 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018-2019 Viktor Kireev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace upl
+{
+
+inline namespace v0_2
+{
+
+// The reclaimer destroys the objects whose destruction is deferred
+// (see the defer_destruction() of the strong pointers) away from the thread
+// that has released them last, either by its own worker thread or by
+// the drain() calls of the application, for example one per event loop tick
+// with a time budget.
+//
+// The objects released by a thread go to the reclaimer of its current scope,
+// or to the background() one. The queue has a fixed capacity: when it is
+// full, the object is destroyed at once by the releasing thread.
+class reclaimer
+{
+public:
+    using Reclaim = void (*)(const void*) noexcept;
+    using clock   = std::chrono::steady_clock;
+
+    struct statistics
+    {
+        std::uint64_t   deferred{0};      // Objects put into the queue.
+        std::uint64_t   destroyed{0};     // Queued objects destroyed by the drains.
+        std::uint64_t   overflowed{0};    // Objects destroyed at once, the queue being full.
+        std::size_t     backlog{0};       // Objects waiting in the queue.
+        clock::duration max_latency{};    // The longest wait in the queue.
+        clock::duration total_latency{};  // The sum of the waits in the queue.
+
+        clock::duration average_latency() const noexcept
+        {
+            return destroyed ? total_latency / static_cast<clock::rep>(destroyed)
+                             : clock::duration{};
+        }
+    };
+
+    static constexpr std::size_t DefaultCapacity = 4096;
+
+    explicit reclaimer(std::size_t capacity = DefaultCapacity)
+        : m_entries(capacity) {}
+
+    reclaimer(const reclaimer&) = delete;
+    reclaimer& operator=(const reclaimer&) = delete;
+
+    // Destroys all the objects that are left in the queue.
+    ~reclaimer()
+    {
+        stop();
+        drain();
+    }
+
+    // Starts the worker thread that drains the queue as soon as
+    // an object is put into it.
+    void start()
+    {
+        std::lock_guard<std::mutex> lock{m_mutex};
+        if (m_running)
+            return;
+
+        m_stopping = false;
+        m_worker   = std::thread{[this] { work(); }};
+        m_running  = true;
+    }
+
+    void stop() noexcept
+    {
+        {
+            std::lock_guard<std::mutex> lock{m_mutex};
+            if (!m_running)
+                return;
+
+            m_stopping = true;
+        }
+
+        m_wake.notify_one();
+        m_worker.join();
+
+        std::lock_guard<std::mutex> lock{m_mutex};
+        m_running = false;
+    }
+
+    // Destroys the queued objects until the budget is spent, but at least
+    // one, and returns the number of the destroyed objects.
+    std::size_t drain(clock::duration budget)
+    {
+        const clock::time_point deadline = clock::now() + budget;
+
+        std::size_t count = 0;
+        while (reclaim_next())
+        {
+            ++count;
+            if (clock::now() >= deadline)
+                break;
+        }
+
+        return count;
+    }
+
+    // Destroys all the queued objects, including the ones queued meanwhile.
+    std::size_t drain()
+    {
+        std::size_t count = 0;
+        while (reclaim_next())
+            ++count;
+
+        return count;
+    }
+
+    statistics stats() const
+    {
+        std::lock_guard<std::mutex> lock{m_mutex};
+        statistics result = m_statistics;
+        result.backlog    = m_size;
+        return result;
+    }
+
+    // Makes the reclaimer receive the objects released by this thread
+    // during the scope.
+    class scope
+    {
+    public:
+        explicit scope(reclaimer& r) noexcept
+            : m_previous{std::exchange(t_current, &r)} {}
+
+        ~scope() { t_current = m_previous; }
+
+        scope(const scope&) = delete;
+        scope& operator=(const scope&) = delete;
+
+    private:
+        reclaimer* m_previous;
+    };
+
+    // The reclaimer with its own worker thread, it is used by the threads
+    // out of any scope. It is destroyed at the exit, and the objects
+    // released after that are destroyed at once.
+    static reclaimer& background()
+    {
+        struct holder
+        {
+            holder() { instance.start(); }
+            ~holder() { s_background_finished.store(true, std::memory_order_release); }
+
+            reclaimer instance;
+        };
+
+        static holder h;
+        return h.instance;
+    }
+
+    // Puts the p into the queue of the current reclaimer. Returns false
+    // if it is not queued, then the caller reclaims it at once.
+    static bool defer(const void* p, Reclaim reclaim_p) noexcept
+    {
+        if (t_current != nullptr)
+            return t_current->push(p, reclaim_p);
+
+        if (s_background_finished.load(std::memory_order_acquire))
+            return false;
+
+        try
+        {
+            return background().push(p, reclaim_p);
+        }
+        catch (...)
+        {
+            return false;
+        }
+    }
+
+private:
+    struct entry
+    {
+        const void*       pointer{nullptr};
+        Reclaim           reclaim{nullptr};
+        clock::time_point queued{};
+    };
+
+    bool push(const void* p, Reclaim reclaim_p) noexcept
+    {
+        const clock::time_point now = clock::now();
+
+        bool wake = false;
+        {
+            std::lock_guard<std::mutex> lock{m_mutex};
+            if (m_size == m_entries.size())
+            {
+                ++m_statistics.overflowed;
+                return false;
+            }
+
+            m_entries[(m_head + m_size) % m_entries.size()] = {p, reclaim_p, now};
+            wake = m_size++ == 0 && m_running;
+            ++m_statistics.deferred;
+        }
+
+        if (wake)
+            m_wake.notify_one();
+
+        return true;
+    }
+
+    // Destroys the first queued object, out of the lock, as its destruction
+    // may queue more objects.
+    bool reclaim_next() noexcept
+    {
+        entry e;
+        {
+            std::lock_guard<std::mutex> lock{m_mutex};
+            if (m_size == 0)
+                return false;
+
+            e      = m_entries[m_head];
+            m_head = (m_head + 1) % m_entries.size();
+            --m_size;
+        }
+
+        const clock::duration latency = clock::now() - e.queued;
+        e.reclaim(e.pointer);
+
+        std::lock_guard<std::mutex> lock{m_mutex};
+        ++m_statistics.destroyed;
+        m_statistics.total_latency += latency;
+        if (latency > m_statistics.max_latency)
+            m_statistics.max_latency = latency;
+
+        return true;
+    }
+
+    void work() noexcept
+    {
+        std::unique_lock<std::mutex> lock{m_mutex};
+        while (!m_stopping)
+        {
+            m_wake.wait(lock, [this] { return m_stopping || m_size != 0; });
+
+            lock.unlock();
+            drain();
+            lock.lock();
+        }
+    }
+
+    mutable std::mutex      m_mutex;
+    std::condition_variable m_wake;
+    std::vector<entry>      m_entries;
+    std::size_t             m_head{0};
+    std::size_t             m_size{0};
+    statistics              m_statistics{};
+    bool                    m_stopping{false};
+    bool                    m_running{false};
+    std::thread             m_worker;
+
+    static inline thread_local reclaimer* t_current{nullptr};
+    static inline std::atomic<bool>       s_background_finished{false};
+};
+
+} // namespace v0_2
+
+} // namespace upl
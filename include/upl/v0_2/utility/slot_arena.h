@@ -0,0 +1,166 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018-2019 Viktor Kireev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <upl/v0_2/detail/concrete.h>
+#include <upl/v0_2/detail/internal/slot.h>
+
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace upl
+{
+
+inline namespace v0_2
+{
+
+// Keeps the objects of the upl::slot pointers in the slots of contiguous
+// chunks, so the objects are densely packed for the iteration. A slot
+// holds the counts of its object, and a weak pointer refers to the slot
+// and the generation of the object, so no control block is allocated and
+// the weak pointers do not keep the memory.
+//
+// The arena and its pointers belong to one thread. The arena must
+// outlive its pointers, all the owners must be released before it
+// is destroyed.
+template <class T>
+class slot_arena : private detail::internal::slot_arena_base
+{
+public:
+    static constexpr std::size_t ChunkSize = 256;
+
+    slot_arena() = default;
+
+    ~slot_arena()
+    { assert(m_size == 0 && "the owners of the objects must be released first"); }
+
+    // Creates an object in a free slot.
+    template <class ... Args>
+    slot::unique<T> make(Args&& ... args)
+    { return slot::unique<T>{std::allocator_arg, this, itself, std::forward<Args>(args) ...}; }
+
+    std::size_t size() const noexcept { return m_size; }
+
+    std::size_t capacity() const noexcept { return m_chunks.size() * ChunkSize; }
+
+    // Calls the f for each object in the order of the slots.
+    // The objects must not be created or destroyed meanwhile.
+    template <class F>
+    void for_each(F&& f)
+    {
+        for (auto& c : m_chunks)
+        {
+            for (cell& s : c->slots)
+            {
+                if (s.header.generation & 1)
+                    f(*s.object());
+            }
+        }
+    }
+
+private:
+    using slot_header = detail::internal::slot_header;
+
+    struct cell
+    {
+        slot_header header;
+        alignas(T) unsigned char storage[sizeof(T)];
+
+        T* object() noexcept
+        { return std::launder(reinterpret_cast<T*>(storage)); }
+    };
+
+    struct chunk
+    {
+        cell slots[ChunkSize];
+    };
+
+    template <class ... Args>
+    std::pair<slot_header*, T*> emplace(Args&& ... args)
+    {
+        cell* s = acquire();
+        try
+        {
+            ::new (static_cast<void*>(s->storage)) T(std::forward<Args>(args) ...);
+        }
+        catch (...)
+        {
+            m_free.push_back(s);
+            throw;
+        }
+
+        ++s->header.generation;
+        s->header.uses = 1;
+        ++m_size;
+        return {&s->header, s->object()};
+    }
+
+    // The weak pointers expire before the object is destroyed.
+    void dispose(slot_header* header) noexcept override
+    {
+        cell* s = reinterpret_cast<cell*>(header);
+        ++header->generation;
+        s->object()->~T();
+        --m_size;
+
+        // The capacity is reserved for all the slots.
+        m_free.push_back(s);
+    }
+
+    cell* acquire()
+    {
+        if (m_free.empty())
+        {
+            m_free.reserve(capacity() + ChunkSize);
+            m_chunks.push_back(std::make_unique<chunk>());
+
+            chunk& c = *m_chunks.back();
+            for (std::size_t i = ChunkSize; i-- > 0;)
+            {
+                c.slots[i].header.arena = this;
+                m_free.push_back(&c.slots[i]);
+            }
+        }
+
+        cell* s = m_free.back();
+        m_free.pop_back();
+        return s;
+    }
+
+    template <class Y, class P>
+    friend class detail::internal::strong_referrer;
+
+    std::vector<std::unique_ptr<chunk>> m_chunks;
+    std::vector<cell*>                  m_free;
+    std::size_t                         m_size{0};
+};
+
+} // namespace v0_2
+
+} // namespace upl
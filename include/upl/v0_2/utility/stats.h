@@ -0,0 +1,321 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018-2019 Viktor Kireev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iomanip>
+#include <mutex>
+#include <ostream>
+#include <utility>
+
+namespace upl
+{
+
+inline namespace v0_2
+{
+
+// The counters of the UPL operations by the ownership kind, which are kept
+// if UPL_STATS is defined (it must be defined in all translation units).
+// Otherwise the operations are not counted at all, and the counts are zero.
+//
+// Each thread counts into its own cache-aligned block, so the counting
+// is a plain increment without the contention between the threads.
+// The blocks are never destroyed: a finished thread passes its block to
+// the next thread, and the totals are summed over all the blocks on demand.
+class stats
+{
+public:
+    enum class event : unsigned
+    {
+        itself_allocation, // An object created together with its block.
+        add_use,           // An owner added.
+        release,           // An owner released.
+        add_weak,          // A weak reference added.
+        release_weak,      // A weak reference released.
+        promote,           // A weak reference turned into an owner.
+        lock,              // A weak pointer locked.
+        lock_failure,      // A weak pointer locked in vain.
+        std_wrap,          // A block created for a std smart pointer.
+        std_unwrap,        // A block reused from a std::shared_ptr.
+        std_share,         // A std::shared_ptr made from a UPL pointer.
+        single_error,      // A single_error constructed.
+        count_
+    };
+
+    enum class kind : unsigned
+    {
+        concurrent,
+        local,
+        intrusive,
+        slot,
+        none,              // The events without an ownership kind.
+        count_
+    };
+
+    static constexpr std::size_t EventCount = std::size_t(event::count_);
+    static constexpr std::size_t KindCount  = std::size_t(kind::count_);
+
+#if defined (UPL_STATS)
+    static constexpr bool IsEnabled = true;
+#else
+    static constexpr bool IsEnabled = false;
+#endif
+
+    struct counts
+    {
+        std::uint64_t values[EventCount][KindCount]{};
+
+        std::uint64_t get(event e, kind k) const noexcept
+        { return values[std::size_t(e)][std::size_t(k)]; }
+
+        std::uint64_t get(event e) const noexcept
+        {
+            std::uint64_t result = 0;
+            for (std::uint64_t value : values[std::size_t(e)])
+                result += value;
+
+            return result;
+        }
+
+        counts& operator+=(const counts& other) noexcept
+        {
+            for (std::size_t e = 0; e < EventCount; ++e)
+                for (std::size_t k = 0; k < KindCount; ++k)
+                    values[e][k] += other.values[e][k];
+
+            return *this;
+        }
+
+        // The counts since the earlier ones.
+        counts& operator-=(const counts& other) noexcept
+        {
+            for (std::size_t e = 0; e < EventCount; ++e)
+                for (std::size_t k = 0; k < KindCount; ++k)
+                    values[e][k] -= other.values[e][k];
+
+            return *this;
+        }
+
+        friend counts operator-(counts a, const counts& b) noexcept
+        { return a -= b; }
+    };
+
+    static void record(event e, kind k) noexcept
+    {
+        if constexpr (IsEnabled)
+        {
+            if (block* own = this_thread_block())
+                ++own->values[std::size_t(e)][std::size_t(k)];
+            else
+                orphan().values[std::size_t(e)][std::size_t(k)].add();
+        }
+    }
+
+    static counts total() noexcept
+    {
+        counts result;
+        if constexpr (IsEnabled)
+        {
+            registry&                   r = blocks();
+            std::lock_guard<std::mutex> lock{r.mutex};
+
+            orphan().collect(result);
+            for (block* b = r.head; b != nullptr; b = b->next)
+                b->collect(result);
+        }
+
+        return result;
+    }
+
+    static const char* name(event e) noexcept
+    {
+        static const char* const names[EventCount] =
+        {
+            "itself_allocation", "add_use", "release", "add_weak",
+            "release_weak", "promote", "lock", "lock_failure", "std_wrap",
+            "std_unwrap", "std_share", "single_error"
+        };
+        return names[std::size_t(e)];
+    }
+
+    static const char* name(kind k) noexcept
+    {
+        static const char* const names[KindCount] =
+        {
+            "concurrent", "local", "intrusive", "slot", "none"
+        };
+        return names[std::size_t(k)];
+    }
+
+    // Writes a table of the counts, a row for each counted event.
+    static void dump(std::ostream& out, const counts& c = total())
+    {
+        out << std::left << std::setw(18) << "event";
+        for (std::size_t k = 0; k < KindCount; ++k)
+            out << std::right << std::setw(12) << name(kind(k));
+        out << '\n';
+
+        for (std::size_t e = 0; e < EventCount; ++e)
+        {
+            if (c.get(event(e)) == 0)
+                continue;
+
+            out << std::left << std::setw(18) << name(event(e));
+            for (std::size_t k = 0; k < KindCount; ++k)
+                out << std::right << std::setw(12) << c.values[e][k];
+            out << '\n';
+        }
+    }
+
+private:
+    // Only the owning thread increments the counter, the others may read it.
+    struct counter
+    {
+        std::atomic<std::uint64_t> value{0};
+
+        void operator++() noexcept
+        { value.store(value.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed); }
+
+        // For the block shared by the finished threads.
+        void add() noexcept
+        { value.fetch_add(1, std::memory_order_relaxed); }
+
+        std::uint64_t load() const noexcept
+        { return value.load(std::memory_order_relaxed); }
+    };
+
+    struct alignas(64) block
+    {
+        void collect(counts& result) const noexcept
+        {
+            for (std::size_t e = 0; e < EventCount; ++e)
+                for (std::size_t k = 0; k < KindCount; ++k)
+                    result.values[e][k] += values[e][k].load();
+        }
+
+        counter values[EventCount][KindCount];
+
+        block* next{nullptr};
+        bool   in_use{false};
+    };
+
+    struct registry
+    {
+        std::mutex mutex;
+        block*     head{nullptr};
+    };
+
+    static registry& blocks() noexcept
+    {
+        static registry* instance = new registry;
+        return *instance;
+    }
+
+    // Counts for the threads that have already passed their blocks.
+    static block& orphan() noexcept
+    {
+        static block* instance = new block;
+        return *instance;
+    }
+
+    static block* acquire_block()
+    {
+        registry&                   r = blocks();
+        std::lock_guard<std::mutex> lock{r.mutex};
+
+        for (block* b = r.head; b != nullptr; b = b->next)
+        {
+            if (!b->in_use)
+            {
+                b->in_use = true;
+                return b;
+            }
+        }
+
+        block* b = new block;
+        b->in_use = true;
+        b->next   = r.head;
+        r.head    = b;
+        return b;
+    }
+
+    static void release_block(block* b) noexcept
+    {
+        registry&                   r = blocks();
+        std::lock_guard<std::mutex> lock{r.mutex};
+        b->in_use = false;
+    }
+
+    enum class state : unsigned char { fresh, alive, finished };
+
+    struct thread_guard
+    {
+        ~thread_guard()
+        {
+            t_state = state::finished;
+            release_block(std::exchange(t_block, nullptr));
+        }
+    };
+
+    static block* this_thread_block() noexcept
+    {
+        if (t_state == state::alive)
+            return t_block;
+
+        if (t_state == state::finished)
+            return nullptr;
+
+        try
+        {
+            t_block = acquire_block();
+        }
+        catch (...)
+        {
+            return nullptr;
+        }
+
+        t_state = state::alive;
+        static thread_local thread_guard guard;
+        return t_block;
+    }
+
+    static inline thread_local state  t_state{state::fresh};
+    static inline thread_local block* t_block{nullptr};
+};
+
+} // namespace v0_2
+
+} // namespace upl
+
+// Counts the event of the stats::kind if UPL_STATS is defined,
+// otherwise expands to nothing.
+#if defined (UPL_STATS)
+#define UPL_STAT(Event, Kind) \
+    ::upl::stats::record(::upl::stats::event::Event, Kind)
+#else
+#define UPL_STAT(Event, Kind) ((void)0)
+#endif
@@ -0,0 +1,447 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018-2019 Viktor Kireev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <utility>
+
+namespace upl
+{
+
+inline namespace v0_2
+{
+
+// The thread_cache serves small allocations of the control blocks and
+// the objects that are created by the 'itself' constructors.
+//
+// Memory is carved from slabs that belong to a thread. A block that is freed
+// by its thread goes to the thread's free list. A block that is freed by
+// another thread is collected into a batch, and the whole batch is passed to
+// the owning thread with one atomic operation. The owning thread picks
+// such blocks up when its own free list is empty.
+//
+// The cache is enabled for all control blocks by defining UPL_THREAD_CACHE
+// (it must be defined in all translation units), or can be used through
+// the thread_cache_allocator. The memory of the slabs is kept for reuse
+// and is not returned to the system.
+class thread_cache
+{
+public:
+    struct statistics
+    {
+        std::uint64_t allocations{0};    // Allocations served by the caches.
+        std::uint64_t hits{0};           // Allocations served by a free list.
+        std::uint64_t local_frees{0};    // Blocks freed by their own thread.
+        std::uint64_t remote_frees{0};   // Blocks freed by another thread.
+        std::uint64_t remote_batches{0}; // Batches passed to the owning threads.
+        std::uint64_t slabs{0};          // Slabs taken from the system.
+        std::uint64_t bypassed{0};       // Allocations too large for the caches.
+
+        double hit_rate() const noexcept
+        { return allocations ? double(hits) / double(allocations) : 0.0; }
+
+        statistics& operator+=(const statistics& other) noexcept
+        {
+            allocations    += other.allocations;
+            hits           += other.hits;
+            local_frees    += other.local_frees;
+            remote_frees   += other.remote_frees;
+            remote_batches += other.remote_batches;
+            slabs          += other.slabs;
+            bypassed       += other.bypassed;
+            return *this;
+        }
+    };
+
+    static constexpr std::size_t Granule    = 16;
+    static constexpr std::size_t MaxSize    = 256;
+    static constexpr std::size_t SlabSize   = 64 * 1024;
+    static constexpr std::size_t BatchLimit = 64;
+
+    static void* allocate(std::size_t size,
+                          std::size_t alignment = alignof(std::max_align_t))
+    {
+        cache* own = this_thread_cache();
+
+        if (!is_cached(size, alignment))
+        {
+            if (own)
+                ++own->bypassed;
+
+            return ::operator new(size, std::align_val_t{alignment});
+        }
+
+        const std::size_t size_class = class_of(size);
+
+        if (own)
+            return own->allocate(size_class);
+
+        std::lock_guard<std::mutex> lock{orphan().mutex};
+        return orphan().allocate(size_class);
+    }
+
+    static void deallocate(void* p, std::size_t size,
+                           std::size_t alignment = alignof(std::max_align_t)) noexcept
+    {
+        if (!is_cached(size, alignment))
+        {
+            ::operator delete(p, std::align_val_t{alignment});
+            return;
+        }
+
+        block* b   = ::new (p) block{nullptr};
+        slab*  s   = slab_of(p);
+        cache* own = this_thread_cache();
+
+        if (own)
+        {
+            if (own == s->owner)
+                own->release(s->size_class, b);
+            else
+                own->send(s->owner, s->size_class, b);
+        }
+        else
+        {
+            std::lock_guard<std::mutex> lock{orphan().mutex};
+            orphan().send(s->owner, s->size_class, b);
+            orphan().flush();
+        }
+    }
+
+    // Passes the pending batch of the current thread to its owner.
+    static void flush() noexcept
+    {
+        if (cache* own = this_thread_cache())
+            own->flush();
+    }
+
+    static statistics this_thread() noexcept
+    {
+        if (cache* own = this_thread_cache())
+            return own->collect();
+
+        return statistics{};
+    }
+
+    static statistics total() noexcept
+    {
+        registry&                   r = caches();
+        std::lock_guard<std::mutex> lock{r.mutex};
+
+        statistics result = orphan().collect();
+        for (cache* c = r.head; c != nullptr; c = c->next)
+            result += c->collect();
+
+        return result;
+    }
+
+private:
+    static constexpr std::size_t ClassCount = MaxSize / Granule;
+
+    struct block
+    { block* next; };
+
+    struct cache;
+
+    struct alignas(Granule) slab
+    {
+        cache*      owner;
+        std::size_t size_class;
+    };
+
+    // Only the owning thread writes the counter, the others may read it.
+    struct counter
+    {
+        std::atomic<std::uint64_t> value{0};
+
+        void operator++() noexcept
+        { value.store(value.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed); }
+
+        std::uint64_t load() const noexcept
+        { return value.load(std::memory_order_relaxed); }
+    };
+
+    struct cache
+    {
+        void* allocate(std::size_t size_class)
+        {
+            ++allocations;
+
+            block*& list = free[size_class];
+            if (list == nullptr)
+                list = inbox[size_class].exchange(nullptr, std::memory_order_acquire);
+
+            if (list != nullptr)
+            {
+                ++hits;
+                block* b = list;
+                list = b->next;
+                return b;
+            }
+
+            const std::size_t size = (size_class + 1) * Granule;
+            if (bump[size_class] + size > bump_end[size_class])
+            {
+                char* memory = static_cast<char*>(
+                    ::operator new(SlabSize, std::align_val_t{SlabSize}));
+                ::new (static_cast<void*>(memory)) slab{this, size_class};
+                bump[size_class]     = memory + sizeof(slab);
+                bump_end[size_class] = memory + SlabSize;
+                ++slabs;
+            }
+
+            void* result = bump[size_class];
+            bump[size_class] += size;
+            return result;
+        }
+
+        void release(std::size_t size_class, block* b) noexcept
+        {
+            ++local_frees;
+            b->next = free[size_class];
+            free[size_class] = b;
+        }
+
+        void send(cache* owner, std::size_t size_class, block* b) noexcept
+        {
+            ++remote_frees;
+
+            if (batch.count != 0
+                && (batch.owner != owner || batch.size_class != size_class))
+                flush();
+
+            if (batch.count == 0)
+            {
+                batch.owner      = owner;
+                batch.size_class = size_class;
+                batch.tail       = b;
+            }
+
+            b->next    = batch.head;
+            batch.head = b;
+
+            if (++batch.count == BatchLimit)
+                flush();
+        }
+
+        void flush() noexcept
+        {
+            if (batch.count == 0)
+                return;
+
+            std::atomic<block*>& target = batch.owner->inbox[batch.size_class];
+
+            block* head = target.load(std::memory_order_relaxed);
+            do
+                batch.tail->next = head;
+            while (!target.compare_exchange_weak(head, batch.head,
+                                                 std::memory_order_release,
+                                                 std::memory_order_relaxed));
+
+            ++remote_batches;
+            batch = pending{};
+        }
+
+        statistics collect() const noexcept
+        {
+            statistics result;
+            result.allocations    = allocations.load();
+            result.hits           = hits.load();
+            result.local_frees    = local_frees.load();
+            result.remote_frees   = remote_frees.load();
+            result.remote_batches = remote_batches.load();
+            result.slabs          = slabs.load();
+            result.bypassed       = bypassed.load();
+            return result;
+        }
+
+        struct pending
+        {
+            cache*      owner{nullptr};
+            std::size_t size_class{0};
+            block*      head{nullptr};
+            block*      tail{nullptr};
+            std::size_t count{0};
+        };
+
+        block*  free[ClassCount]{};
+        char*   bump[ClassCount]{};
+        char*   bump_end[ClassCount]{};
+        pending batch{};
+
+        counter allocations;
+        counter hits;
+        counter local_frees;
+        counter remote_frees;
+        counter remote_batches;
+        counter slabs;
+        counter bypassed;
+
+        alignas(64) std::atomic<block*> inbox[ClassCount]{};
+
+        cache*     next{nullptr};
+        bool       in_use{false};
+        std::mutex mutex;
+    };
+
+    // The caches are never destroyed: their slabs may be still in use
+    // after the threads have finished.
+    struct registry
+    {
+        std::mutex mutex;
+        cache*     head{nullptr};
+    };
+
+    static registry& caches() noexcept
+    {
+        static registry* instance = new registry;
+        return *instance;
+    }
+
+    // Serves the threads that have already destroyed their caches.
+    static cache& orphan() noexcept
+    {
+        static cache* instance = new cache;
+        return *instance;
+    }
+
+    static cache* acquire_cache()
+    {
+        registry&                   r = caches();
+        std::lock_guard<std::mutex> lock{r.mutex};
+
+        for (cache* c = r.head; c != nullptr; c = c->next)
+        {
+            if (!c->in_use)
+            {
+                c->in_use = true;
+                return c;
+            }
+        }
+
+        cache* c = new cache;
+        c->in_use = true;
+        c->next   = r.head;
+        r.head    = c;
+        return c;
+    }
+
+    static void release_cache(cache* c) noexcept
+    {
+        c->flush();
+
+        registry&                   r = caches();
+        std::lock_guard<std::mutex> lock{r.mutex};
+        c->in_use = false;
+    }
+
+    enum class state : unsigned char { fresh, alive, finished };
+
+    struct thread_guard
+    {
+        ~thread_guard()
+        {
+            t_state = state::finished;
+            release_cache(std::exchange(t_cache, nullptr));
+        }
+    };
+
+    static cache* this_thread_cache() noexcept
+    {
+        if (t_state == state::alive)
+            return t_cache;
+
+        if (t_state == state::finished)
+            return nullptr;
+
+        try
+        {
+            t_cache = acquire_cache();
+        }
+        catch (...)
+        {
+            return nullptr;
+        }
+
+        t_state = state::alive;
+        static thread_local thread_guard guard;
+        return t_cache;
+    }
+
+    static bool is_cached(std::size_t size, std::size_t alignment) noexcept
+    { return size != 0 && size <= MaxSize && alignment <= Granule; }
+
+    static std::size_t class_of(std::size_t size) noexcept
+    { return (size - 1) / Granule; }
+
+    static slab* slab_of(void* p) noexcept
+    {
+        return reinterpret_cast<slab*>(
+            reinterpret_cast<std::uintptr_t>(p) & ~(std::uintptr_t{SlabSize} - 1));
+    }
+
+    static inline thread_local state  t_state{state::fresh};
+    static inline thread_local cache* t_cache{nullptr};
+};
+
+// The standard allocator over the thread_cache.
+template <class T>
+class thread_cache_allocator
+{
+public:
+    using value_type = T;
+
+    thread_cache_allocator() noexcept = default;
+
+    template <class U>
+    thread_cache_allocator(const thread_cache_allocator<U>&) noexcept {}
+
+    T* allocate(std::size_t n)
+    {
+        if (n > std::size_t(-1) / sizeof(T))
+            throw std::bad_array_new_length{};
+
+        return static_cast<T*>(thread_cache::allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T* p, std::size_t n) noexcept
+    { thread_cache::deallocate(p, n * sizeof(T), alignof(T)); }
+
+    template <class U>
+    bool operator==(const thread_cache_allocator<U>&) const noexcept
+    { return true; }
+
+    template <class U>
+    bool operator!=(const thread_cache_allocator<U>&) const noexcept
+    { return false; }
+};
+
+} // namespace v0_2
+
+} // namespace upl
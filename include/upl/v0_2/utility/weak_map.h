@@ -0,0 +1,271 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018-2019 Viktor Kireev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <upl/v0_2/detail/concrete.h>
+#include <upl/v0_2/utility/flat_owner.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+namespace upl
+{
+
+inline namespace v0_2
+{
+
+// A map from the objects, which it does not own, to the values. The entries
+// of the expired objects are purged incrementally: each operation that
+// changes the map or looks it up examines a few slots of the table after
+// the place where the previous one stopped, so the dead entries are
+// removed without full scans and their number stays proportional to
+// the size of the map. An entry of an expired object is never found.
+//
+// The keys are the WeakKey pointers, which are kept in a flat_owner_map.
+template <class K, class V, class WeakKey = weak<K>>
+class weak_map
+{
+    using table = detail::internal::flat_owner_table<WeakKey, V>;
+
+public:
+    using key_type    = WeakKey;
+    using mapped_type = V;
+    using size_type   = std::size_t;
+
+    // The slots examined by the purge on each operation.
+    static constexpr size_type PurgeStep = 4;
+
+    struct statistics
+    {
+        size_type     size{0};       // Entries, including the dead ones not purged yet.
+        size_type     capacity{0};   // Slots of the table.
+        std::uint64_t purged{0};     // Dead entries removed by the purge.
+        std::uint64_t examined{0};   // Slots examined by the purge.
+        std::uint64_t sweeps{0};     // Complete passes of the purge over the table.
+        double        dead_ratio{0}; // The share of the dead entries met by the last pass.
+    };
+
+    weak_map() noexcept = default;
+
+    explicit weak_map(size_type count)
+    { m_table.reserve(count); }
+
+    // Inserts a value constructed from the args if there is no entry for
+    // the object of the pointer. Returns the value and whether it is new.
+    template <class Pointer, class ... Args>
+    std::pair<V&, bool> try_emplace(const Pointer& pointer, Args&& ... args)
+    {
+        purge(PurgeStep);
+
+        // The dead entries are dropped instead of growing the table.
+        if (m_table.needs_rehash())
+            purge(m_table.capacity());
+
+        auto [index, inserted] = m_table.find_or_emplace(
+            pointer, std::piecewise_construct,
+            std::forward_as_tuple(pointer),
+            std::forward_as_tuple(std::forward<Args>(args) ...));
+
+        return {m_table.slot(index).second, inserted};
+    }
+
+    template <class Pointer, class M>
+    std::pair<V&, bool> insert_or_assign(const Pointer& pointer, M&& value)
+    {
+        auto result = try_emplace(pointer, std::forward<M>(value));
+        if (!result.second)
+            result.first = std::forward<M>(value);
+
+        return result;
+    }
+
+    template <class Pointer>
+    V& operator[](const Pointer& pointer)
+    { return try_emplace(pointer).first; }
+
+    // Returns the value of the alive object, or nullptr.
+    template <class Pointer>
+    V* find(const Pointer& pointer)
+    {
+        purge(PurgeStep);
+
+        const size_type index = m_table.find(pointer);
+        if (index == m_table.capacity())
+            return nullptr;
+
+        if (m_table.slot(index).first.expired())
+        {
+            erase_dead(index);
+            return nullptr;
+        }
+
+        return &m_table.slot(index).second;
+    }
+
+    // Returns the value of the alive object, or nullptr, without the purge.
+    template <class Pointer>
+    const V* find(const Pointer& pointer) const noexcept (table::template IsNothrowKey<Pointer>)
+    {
+        const size_type index = m_table.find(pointer);
+        if (index == m_table.capacity() || m_table.slot(index).first.expired())
+            return nullptr;
+
+        return &m_table.slot(index).second;
+    }
+
+    template <class Pointer>
+    bool contains(const Pointer& pointer)
+    { return find(pointer) != nullptr; }
+
+    template <class Pointer>
+    bool contains(const Pointer& pointer) const noexcept (table::template IsNothrowKey<Pointer>)
+    { return find(pointer) != nullptr; }
+
+    template <class Pointer>
+    bool erase(const Pointer& pointer)
+    {
+        purge(PurgeStep);
+
+        const size_type index = m_table.find(pointer);
+        if (index == m_table.capacity())
+            return false;
+
+        const bool alive = !m_table.slot(index).first.expired();
+        m_table.erase(index);
+        return alive;
+    }
+
+    // Calls the f(key, value) for the entries of the alive objects,
+    // purging the dead ones on the way. The map must not be changed
+    // meanwhile.
+    template <class F>
+    void for_each(F&& f)
+    {
+        for (size_type i = m_table.next(0); i != m_table.capacity(); i = m_table.next(i + 1))
+        {
+            auto& s = m_table.slot(i);
+            if (s.first.expired())
+                erase_dead(i);
+            else
+                f(std::as_const(s.first), s.second);
+        }
+    }
+
+    // Examines the budget of slots after the place where the previous
+    // purge stopped, and removes the dead entries among them.
+    void purge(size_type budget) noexcept
+    {
+        const size_type capacity = m_table.capacity();
+        if (capacity == 0)
+            return;
+
+        if (m_cursor >= capacity)
+            m_cursor = 0;
+
+        m_examined += budget;
+        for (; budget != 0; --budget)
+        {
+            const size_type i = m_cursor;
+            if (m_table.next(i) == i)
+            {
+                if (m_table.slot(i).first.expired())
+                {
+                    erase_dead(i);
+                    ++m_sweep_dead;
+                }
+                else
+                {
+                    ++m_sweep_alive;
+                }
+            }
+
+            if (++m_cursor == capacity)
+                complete_sweep();
+        }
+    }
+
+    // Removes all the dead entries.
+    void purge_all() noexcept
+    {
+        m_cursor = 0;
+        purge(m_table.capacity());
+    }
+
+    // The number of the entries, including the dead ones not purged yet.
+    size_type size() const noexcept { return m_table.size(); }
+    bool empty() const noexcept     { return m_table.size() == 0; }
+
+    void reserve(size_type count) { m_table.reserve(count); }
+
+    void clear() noexcept
+    {
+        m_table.clear();
+        m_cursor = 0;
+    }
+
+    statistics stats() const noexcept
+    {
+        statistics result;
+        result.size       = m_table.size();
+        result.capacity   = m_table.capacity();
+        result.purged     = m_purged;
+        result.examined   = m_examined;
+        result.sweeps     = m_sweeps;
+        result.dead_ratio = m_dead_ratio;
+        return result;
+    }
+
+private:
+    void erase_dead(size_type index) noexcept
+    {
+        m_table.erase(index);
+        ++m_purged;
+    }
+
+    void complete_sweep() noexcept
+    {
+        const size_type met = m_sweep_alive + m_sweep_dead;
+        m_dead_ratio  = met ? double(m_sweep_dead) / double(met) : 0.0;
+        m_sweep_alive = 0;
+        m_sweep_dead  = 0;
+        m_cursor      = 0;
+        ++m_sweeps;
+    }
+
+    table m_table;
+
+    size_type     m_cursor{0};
+    size_type     m_sweep_alive{0};
+    size_type     m_sweep_dead{0};
+    std::uint64_t m_purged{0};
+    std::uint64_t m_examined{0};
+    std::uint64_t m_sweeps{0};
+    double        m_dead_ratio{0};
+};
+
+} // namespace v0_2
+
+} // namespace upl
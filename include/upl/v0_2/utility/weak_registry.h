@@ -0,0 +1,313 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018-2019 Viktor Kireev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <upl/v0_2/access.h>
+#include <upl/v0_2/detail/concrete.h>
+#include <upl/v0_2/utility/atomic.h>
+#include <upl/v0_2/utility/flat_owner.h>
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace upl
+{
+
+inline namespace v0_2
+{
+
+// A registry of the weak subscribers for the signal/slot notification.
+// The subscribers are kept in an append-only list of fixed chunks.
+// The subscribe appends to the last chunk and publishes the new size
+// of the chunk, the unsubscribe marks the entry removed, so both take
+// constant time under the mutex of the writers, which also keeps an index
+// of the subscribed owners. A notifier loads the current list lock-free and
+// visits the subscribers without locking them, so the notifiers neither
+// wait for the writers nor for each other. When a quarter of the list
+// is removed or expired, the list is compacted into a new one, by a writer
+// or by a notifier, unless a writer is busy with it.
+template <class T>
+class weak_registry
+{
+public:
+    using weak_type = weak<T>;
+    using list_type = std::vector<weak_type>;
+    using size_type = std::size_t;
+
+    weak_registry() noexcept = default;
+
+    weak_registry(const weak_registry&) = delete;
+    weak_registry& operator=(const weak_registry&) = delete;
+
+    // Adds the subscriber, unless its owner is subscribed already.
+    // A bare unique gets its control block before the lock is taken.
+    template <class Pointer>
+    bool subscribe(const Pointer& pointer)
+    {
+        if constexpr (detail::internal::IsBareOwner<Pointer>)
+            detail::internal::attacher::share(pointer);
+
+        const std::lock_guard<std::mutex> lock{m_mutex};
+
+        auto [position, inserted] = m_index.try_emplace(pointer, nullptr);
+        if (!inserted)
+            return false;
+
+        try
+        {
+            position->second = append(weak_type{pointer});
+        }
+        catch (...)
+        {
+            m_index.erase(position);
+            throw;
+        }
+
+        return true;
+    }
+
+    // Removes the subscriber with the owner of the pointer.
+    template <class Pointer>
+    bool unsubscribe(const Pointer& pointer)
+    {
+        const std::lock_guard<std::mutex> lock{m_mutex};
+
+        const auto position = m_index.find(pointer);
+        if (position == m_index.end())
+            return false;
+
+        position->second->removed.store(true, std::memory_order_release);
+        m_index.erase(position);
+
+        const auto current = m_list.load();
+        current->alive.fetch_sub(1, std::memory_order_relaxed);
+        if (++current->removed * CompactRatio >= current->count)
+            compact_locked();
+
+        return true;
+    }
+
+    // Calls the f(T&) for each alive subscriber, returns their number.
+    // The f may subscribe and unsubscribe, the change is seen by the next
+    // notification.
+    template <class F>
+    size_type notify(F&& f)
+    {
+        const auto current = m_list.load();
+        if (!current)
+            return 0;
+
+        size_type alive   = 0;
+        size_type visited = 0;
+        for (const chunk* c = &current->head; c != nullptr;
+             c = c->next.load(std::memory_order_acquire))
+        {
+            const size_type size = c->size.load(std::memory_order_acquire);
+            for (size_type i = 0; i < size; ++i)
+            {
+                const entry& e = c->entries[i];
+                if (e.removed.load(std::memory_order_acquire))
+                    continue;
+
+                ++visited;
+                if (upl::visit(e.weak, [&](auto& object) { f(object); }))
+                    ++alive;
+            }
+        }
+
+        const size_type expired = visited - alive;
+        if (expired != 0 && expired * CompactRatio >= visited)
+            try_compact();
+
+        return alive;
+    }
+
+    // The current subscribers, which may contain the expired ones.
+    // The list never changes.
+    shared<const list_type> snapshot() const
+    {
+        const auto current = m_list.load();
+        if (!current)
+            return shared<const list_type>{};
+
+        list_type list;
+        list.reserve(current->alive.load(std::memory_order_relaxed));
+        for_each(*current, [&](const entry& e) { list.push_back(e.weak); });
+        return shared<list_type>{itself, std::move(list)};
+    }
+
+    // The number of the subscribers, including the expired ones not
+    // removed yet.
+    size_type size() const
+    {
+        const auto current = m_list.load();
+        return current ? current->alive.load(std::memory_order_relaxed) : 0;
+    }
+
+    // Removes the expired subscribers.
+    void compact()
+    {
+        const std::lock_guard<std::mutex> lock{m_mutex};
+        compact_locked();
+    }
+
+    void clear()
+    {
+        const std::lock_guard<std::mutex> lock{m_mutex};
+        m_list.store(nullptr);
+        m_index.clear();
+    }
+
+private:
+    // The list is compacted when at least this share of it is removed
+    // or expired.
+    static constexpr size_type CompactRatio = 4;
+
+    // The number of the entries in a chunk.
+    static constexpr size_type ChunkSize = 64;
+
+    struct entry
+    {
+        weak_type         weak;
+        std::atomic<bool> removed{false};
+    };
+
+    // The entries below the size are published and never move.
+    struct chunk
+    {
+        entry                  entries[ChunkSize];
+        std::atomic<size_type> size{0};
+        std::atomic<chunk*>    next{nullptr};
+    };
+
+    // The notifiers read the chunks, the rest is changed by the writers.
+    struct list
+    {
+        list() noexcept = default;
+
+        list(const list&) = delete;
+        list& operator=(const list&) = delete;
+
+        ~list()
+        {
+            for (chunk* c = head.next.load(std::memory_order_relaxed); c != nullptr;)
+                delete std::exchange(c, c->next.load(std::memory_order_relaxed));
+        }
+
+        chunk                  head;
+        chunk*                 tail{&head};
+        size_type              count{0};    // The appended entries.
+        size_type              removed{0};  // The entries marked removed.
+        std::atomic<size_type> alive{0};    // The entries not removed.
+    };
+
+    template <class F>
+    static void for_each(const list& l, F&& f)
+    {
+        for (const chunk* c = &l.head; c != nullptr;
+             c = c->next.load(std::memory_order_acquire))
+        {
+            const size_type size = c->size.load(std::memory_order_acquire);
+            for (size_type i = 0; i < size; ++i)
+            {
+                if (!c->entries[i].removed.load(std::memory_order_acquire))
+                    f(c->entries[i]);
+            }
+        }
+    }
+
+    entry* append(weak_type&& weak)
+    {
+        auto current = m_list.load();
+        if (!current)
+        {
+            current = shared<list>{itself};
+            m_list.store(current);
+        }
+
+        return append(*current, std::move(weak));
+    }
+
+    // The entry is filled before the size publishes it.
+    static entry* append(list& l, weak_type&& weak)
+    {
+        chunk* c = l.tail;
+        size_type size = c->size.load(std::memory_order_relaxed);
+        if (size == ChunkSize)
+        {
+            auto created = std::make_unique<chunk>();
+            c->next.store(created.get(), std::memory_order_release);
+            c    = created.release();
+            l.tail = c;
+            size = 0;
+        }
+
+        entry& e = c->entries[size];
+        e.weak = std::move(weak);
+        c->size.store(size + 1, std::memory_order_release);
+        ++l.count;
+        l.alive.fetch_add(1, std::memory_order_relaxed);
+        return &e;
+    }
+
+    void try_compact()
+    {
+        const std::unique_lock<std::mutex> lock{m_mutex, std::try_to_lock};
+        if (lock)
+            compact_locked();
+    }
+
+    // Moves the alive subscribers into a new list, since the notifiers
+    // may still read the current one.
+    void compact_locked()
+    {
+        const auto current = m_list.load();
+        if (!current)
+            return;
+
+        const shared<list> compacted{itself};
+        for_each(*current, [&](const entry& e)
+        {
+            if (e.weak.expired())
+                m_index.erase(e.weak);
+            else
+                m_index[e.weak] = append(*compacted, weak_type{e.weak});
+        });
+
+        m_list.store(compacted->count != 0 ? compacted : shared<list>{});
+    }
+
+    atomic_shared<list>                m_list;
+    std::mutex                         m_mutex;
+    flat_owner_map<weak_type, entry*>  m_index;
+};
+
+} // namespace v0_2
+
+} // namespace upl
@@ -0,0 +1,40 @@
+# Copyright (c) 2018-2019 Viktor Kireev
+# Distributed under the MIT License
+
+# Compiles the SOURCE to the assembly OUTPUT by the COMPILER and fails
+# if the body of any upl_* function has a conditional branch
+# or refers to the single_error.
+
+execute_process(COMMAND ${COMPILER} -std=c++17 -O2 -DNDEBUG -S
+                        -I${INCLUDE_PATH} ${SOURCE} -o ${OUTPUT}
+                RESULT_VARIABLE result
+                ERROR_VARIABLE  error)
+if(result)
+    message(FATAL_ERROR "Can't compile ${SOURCE}:\n${error}")
+endif()
+
+# The conditional branches of x86 and AArch64.
+set(branch "^[ \t]+(j(e|ne|z|nz|a|ae|b|be|g|ge|l|le|s|ns|o|no|p|np|c|nc|cxz|ecxz|rcxz)|b\\.[a-z]+|cbn?z|tbn?z)[ \t]")
+
+file(STRINGS ${OUTPUT} lines)
+
+set(function "")
+set(checked 0)
+foreach(line IN LISTS lines)
+    if(line MATCHES "^(upl_[a-z_]+):")
+        set(function ${CMAKE_MATCH_1})
+        math(EXPR checked "${checked} + 1")
+    elseif(function AND line MATCHES "(\\.cfi_endproc|^\\.Lfunc_end|^[ \t]+\\.size)")
+        set(function "")
+    elseif(function AND line MATCHES "single_error")
+        message(FATAL_ERROR "${function} refers to the single_error: ${line}")
+    elseif(function AND line MATCHES "${branch}")
+        message(FATAL_ERROR "${function} has a conditional branch: ${line}")
+    endif()
+endforeach()
+
+if(checked EQUAL 0)
+    message(FATAL_ERROR "No upl_* function is found in ${OUTPUT}")
+endif()
+
+message(STATUS "${checked} functions have no branches")
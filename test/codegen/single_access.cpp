@@ -0,0 +1,54 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018-2019 Viktor Kireev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+// The access through a 'single' outside the checked mode must compile
+// to plain loads: no null check and no single_error. The functions are
+// compiled to the assembly by the test, which looks for the conditional
+// branches in their bodies.
+
+#include <upl/pointer.h>
+
+struct object
+{
+    int value;
+};
+
+extern "C" {
+
+object* upl_unique_single_get(const upl::unique_single<object>& p) { return p.get(); }
+int upl_unique_single_deref(const upl::unique_single<object>& p) { return (*p).value; }
+int upl_unique_single_arrow(const upl::unique_single<object>& p) { return p->value; }
+
+object* upl_shared_single_get(const upl::shared_single<object>& p) { return p.get(); }
+int upl_shared_single_deref(const upl::shared_single<object>& p) { return (*p).value; }
+int upl_shared_single_arrow(const upl::shared_single<object>& p) { return p->value; }
+
+object* upl_unified_single_get(const upl::unified_single<object>& p) { return p.get(); }
+int upl_unified_single_deref(const upl::unified_single<object>& p) { return (*p).value; }
+int upl_unified_single_arrow(const upl::unified_single<object>& p) { return p->value; }
+
+bool upl_shared_single_not_null(const upl::shared_single<object>& p) { return p.get() != nullptr; }
+
+} // extern "C"
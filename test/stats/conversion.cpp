@@ -0,0 +1,262 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018-2019 Viktor Kireev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+// The rvalue conversions between the pointers must steal the reference
+// of the source instead of adding a new one. The test counts the
+// reference operations of each conversion through the statistics,
+// so the whole target is built with UPL_STATS.
+
+#include <upl/pointer.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <utility>
+
+namespace
+{
+
+struct object { int value{}; };
+struct derived : object {};
+struct intrusive_object : upl::intrusive_base { int value{}; };
+
+struct expected
+{
+    std::uint64_t add_use;
+    std::uint64_t release;
+    std::uint64_t promote;
+};
+
+int failures = 0;
+
+void check(const char* name, bool condition)
+{
+    if (!condition)
+    {
+        std::printf("FAILED: %s\n", name);
+        ++failures;
+    }
+}
+
+template <class Conversion>
+void check_counts(const char* name, expected e, Conversion conversion)
+{
+    using upl::stats;
+    using event = stats::event;
+
+    const auto before = stats::total();
+    conversion();
+    const auto delta = stats::total() - before;
+
+    const std::uint64_t add_use = delta.get(event::add_use);
+    const std::uint64_t release = delta.get(event::release);
+    const std::uint64_t promote = delta.get(event::promote);
+
+    if (add_use != e.add_use || release != e.release || promote != e.promote)
+    {
+        std::printf("FAILED: %s: add_use %llu (%llu), release %llu (%llu), "
+                    "promote %llu (%llu)\n", name,
+                    static_cast<unsigned long long>(add_use),
+                    static_cast<unsigned long long>(e.add_use),
+                    static_cast<unsigned long long>(release),
+                    static_cast<unsigned long long>(e.release),
+                    static_cast<unsigned long long>(promote),
+                    static_cast<unsigned long long>(e.promote));
+        ++failures;
+    }
+}
+
+void from_unique()
+{
+    {
+        upl::unique<object> source{upl::itself};
+        upl::unified<object> target;
+        check_counts("unified = unique&&", {0, 0, 0},
+                     [&] { target = std::move(source); });
+        check("unified = unique&&: moved", !source && target);
+    }
+    {
+        upl::unique<derived> source{upl::itself};
+        upl::unified<object> target;
+        check_counts("unified<base> = unique<derived>&&", {0, 0, 0},
+                     [&] { target = std::move(source); });
+        check("unified<base> = unique<derived>&&: moved", !source && target);
+    }
+    {
+        upl::unique<object> source{upl::itself};
+        upl::shared<object> target;
+        check_counts("shared = unique&&", {0, 0, 0},
+                     [&] { target = std::move(source); });
+        check("shared = unique&&: moved", !source && target.use_count() == 1);
+    }
+    {
+        upl::unique<intrusive_object> source{upl::itself};
+        upl::shared<intrusive_object> target;
+        check_counts("intrusive shared = unique&&", {0, 0, 0},
+                     [&] { target = std::move(source); });
+        check("intrusive shared = unique&&: moved",
+              !source && target.use_count() == 1);
+    }
+}
+
+void from_shared()
+{
+    upl::shared<object> keep{upl::itself};
+    {
+        upl::shared<object> source = keep;
+        upl::unified<object> target;
+        check_counts("unified = shared&&", {0, 0, 0},
+                     [&] { target = std::move(source); });
+        check("unified = shared&&: moved",
+              !source && keep.use_count() == 2);
+    }
+    {
+        upl::shared<object> source = keep;
+        upl::shared<object> target{upl::itself};
+        check_counts("shared = shared&& (releases the old)", {0, 1, 0},
+                     [&] { target = std::move(source); });
+        check("shared = shared&&: moved", !source && keep.use_count() == 2);
+    }
+    {
+        upl::shared<intrusive_object> keep_intrusive{upl::itself};
+        upl::shared<intrusive_object> source = keep_intrusive;
+        upl::unified<intrusive_object> target;
+        check_counts("intrusive unified = shared&&", {0, 0, 0},
+                     [&] { target = std::move(source); });
+        check("intrusive unified = shared&&: moved",
+              !source && keep_intrusive.use_count() == 2);
+    }
+}
+
+void from_unified()
+{
+    upl::shared<object> keep{upl::itself};
+    {
+        upl::unified<object> source = keep;
+        upl::unified<object> target;
+        check_counts("unified = unified&&", {0, 0, 0},
+                     [&] { target = std::move(source); });
+        check("unified = unified&&: moved",
+              !source && keep.use_count() == 2);
+    }
+    {
+        upl::unified<object> source{upl::unique<object>{upl::itself}};
+        upl::unified<object> target = keep;
+        check_counts("unified = unified&& (releases the old)", {0, 1, 0},
+                     [&] { target = std::move(source); });
+        check("unified = unified&& (releases the old): moved",
+              !source && target && keep.use_count() == 1);
+    }
+}
+
+void from_weak()
+{
+    upl::shared<object> keep{upl::itself};
+    {
+        upl::weak<object> source = keep;
+        upl::unified<object> target;
+        check_counts("unified = weak&& (alive)", {0, 0, 1},
+                     [&] { target = std::move(source); });
+        check("unified = weak&& (alive): promoted",
+              target.get() == keep.get() && !source.lock());
+    }
+    {
+        upl::weak<object> source;
+        {
+            upl::shared<object> temporary{upl::itself};
+            source = temporary;
+        }
+        upl::unified<object> target;
+        check_counts("unified = weak&& (expired)", {0, 0, 0},
+                     [&] { target = std::move(source); });
+        check("unified = weak&& (expired): empty", !target);
+    }
+    {
+        upl::local::shared<object> local_keep{upl::itself};
+        upl::local::weak<object> source = local_keep;
+        upl::local::unified<object> target;
+        check_counts("local unified = weak&&", {0, 0, 1},
+                     [&] { target = std::move(source); });
+        check("local unified = weak&&: promoted",
+              target.get() == local_keep.get() && local_keep.use_count() == 2);
+    }
+    {
+        upl::shared<intrusive_object> keep_intrusive{upl::itself};
+        upl::weak<intrusive_object> source = keep_intrusive;
+        upl::unified<intrusive_object> target;
+        check_counts("intrusive unified = weak&&", {0, 0, 1},
+                     [&] { target = std::move(source); });
+        check("intrusive unified = weak&&: promoted",
+              target.get() == keep_intrusive.get() && !source.lock());
+    }
+}
+
+void from_std()
+{
+    {
+        auto source = std::make_shared<object>();
+        const auto raw = source.get();
+        upl::shared<object> target;
+        check_counts("shared = std::shared_ptr&&", {0, 0, 0},
+                     [&] { target = std::move(source); });
+        check("shared = std::shared_ptr&&: moved",
+              !source && target.get() == raw);
+    }
+    {
+        auto keep = std::make_shared<object>();
+        std::weak_ptr<object> source = keep;
+        upl::unified<object> target;
+        check_counts("unified = std::weak_ptr&&", {0, 0, 0},
+                     [&] { target = upl::unified<object>{std::move(source)}; });
+        check("unified = std::weak_ptr&&: locked", target.get() == keep.get());
+    }
+    {
+        upl::shared<object> source{upl::itself};
+        const auto raw = source.get();
+        std::shared_ptr<object> target;
+        check_counts("std::shared_ptr = shared&&", {0, 0, 0},
+                     [&] { target = std::move(source); });
+        check("std::shared_ptr = shared&&: moved",
+              !source && target.get() == raw);
+    }
+}
+
+} // namespace
+
+int main()
+{
+    from_unique();
+    from_shared();
+    from_unified();
+    from_weak();
+    from_std();
+
+    if (failures)
+        return 1;
+
+    std::puts("All the conversions are counted as expected.");
+    return 0;
+}